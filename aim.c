@@ -0,0 +1,308 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "generator.h"
+
+/*
+
+Aim tables of other sizes than 16x16, and how good they are. An NxN table (N = 8, 16, 32 or 64) is read the same
+way as aim_matrix: |dx| and |dy| are shifted right until both are below N, and the table gives the angle of the
+first quadrant, fixed up by the signs. The shift is log2(N) bits per iteration like the 16x16 table (4 bits), or
+1 bit, which keeps more precision for more iterations.
+
+--aim-report sweeps every enemy/player offset of a 256x192 screen, dx from -255 to 255 and dy from -191 to 191,
+each one weighted by how many enemy/player pairs have it, and compares the table angle with atan2 in angle
+indices (1 index = 2.8125 degrees). Even an exact atan2 rounded to 128 angles is up to 0.5 off.
+
+The log tables aim without the shift loop, in the same time whatever the distance. AimLog[v] is log2(v) in
+AIM_LOG_SCALE steps per octave, so AimLog[|dy|] - AimLog[|dx|] is the log of the ratio dy/dx, and AimLogAngle[d]
+is the first quadrant angle of that ratio (dy >= dx, the other half is 32 - AimLogAngle[-d]). AimLog[0] is 0 and
+every other entry is raised by AIM_LOG_ZERO, the first difference where the angle is already 32: a zero dx or dy
+gives a difference past it, straight up/down or left/right, with no test. Two 256 bytes tables, one page each.
+
+*/
+
+#define AIM_SCREEN_W    256
+#define AIM_SCREEN_H    192
+#define AIM_BUCKETS     7
+
+#define AIM_LOG_SCALE   16      // the largest that keeps AIM_LOG_ZERO + log2(255) in a byte
+
+static const double aim_buckets[AIM_BUCKETS]={0.5, 1, 1.5, 2, 3, 4, 1e9};
+
+uint8_t aim_log[256], aim_log_angle[256];
+static int aim_log_zero;
+
+// First quadrant angle of a table entry, the same formula as targeting16x16
+int aim_entry(int dx, int dy){
+    if(dx==0 && dy==0)
+        return 32;
+    return (int)(((atan2((double)dy, (double)dx)/(M_PI/2))*ANGLES_PER_QUADRANT)+0.5);
+}
+
+// log2 of a table size
+int aim_bits(int size){
+    int bits=0;
+
+    while((1<<bits)<size)
+        bits++;
+    return bits;
+}
+
+// Builds a size x size table, [dy*size+dx]
+void aim_build(int size, uint8_t *table){
+    for(int dy=0;dy<size;dy++)
+        for(int dx=0;dx<size;dx++)
+            table[dx+size*dy]=aim_entry(dx, dy);
+}
+
+// First quadrant angle fixed up for the quadrant, bit 0 dx<0, bit 1 dy<0
+int aim_quadrant(int angle, int quadrant){
+    switch(quadrant){
+        case 1:  return 64 - angle;
+        case 2:  return (128 - angle) & 127;
+        case 3:  return 64 + angle;
+        default: return angle;
+    }
+}
+
+// Angle of the shot along (dx, dy) read from a table, as described at the top of paths.c. iterations may be NULL
+int aim_angle(const uint8_t *table, int size, int shift, int dx, int dy, int *iterations){
+    int adx=abs(dx), ady=abs(dy), angle, count=0;
+
+    while(adx>=size || ady>=size){
+        adx>>=shift;
+        ady>>=shift;
+        count++;
+    }
+    if(iterations)
+        *iterations=count;
+    angle=table[adx+size*ady];
+    return aim_quadrant(angle, (dx<0)|(dy<0)<<1);
+}
+
+// First quadrant angle of a log difference, for dy >= dx
+static int aim_log_entry(int d){
+    return lround(atan(pow(2, (double)d/AIM_LOG_SCALE))*2*ANGLES_PER_QUADRANT/M_PI);
+}
+
+// Builds AimLog and AimLogAngle
+void aim_log_build(void){
+    for(aim_log_zero=0;aim_log_entry(aim_log_zero)<ANGLES_PER_QUADRANT;aim_log_zero++);
+    aim_log[0]=0;
+    for(int v=1;v<256;v++)
+        aim_log[v]=aim_log_zero+lround(log2(v)*AIM_LOG_SCALE);
+    for(int d=0;d<256;d++)
+        aim_log_angle[d]=aim_log_entry(d);
+}
+
+// Angle of the shot along (dx, dy), |dx| and |dy| up to 255, read from the log tables
+int aim_log_angle_of(int dx, int dy){
+    int d=aim_log[abs(dy)]-aim_log[abs(dx)];
+    int angle=d>=0 ? aim_log_angle[d] : ANGLES_PER_QUADRANT-aim_log_angle[-d];
+
+    return aim_quadrant(angle, (dx<0)|(dy<0)<<1);
+}
+
+// A way to aim: a table read after the shift loop, or the log tables when table is NULL
+typedef struct AimMethod{
+    const uint8_t   *table;
+    int             size, shift;
+}AimMethod;
+
+static int aim_method_angle(const AimMethod *m, int dx, int dy, int *iterations){
+    if(m->table)
+        return aim_angle(m->table, m->size, m->shift, dx, dy, iterations);
+    *iterations=0;
+    return aim_log_angle_of(dx, dy);
+}
+
+typedef struct AimStats{
+    double  max, total, weight, iterations;
+    int     max_iterations;
+    double  buckets[AIM_BUCKETS];
+}AimStats;
+
+static void aim_sweep(const AimMethod *m, AimStats *s){
+    memset(s, 0, sizeof(AimStats));
+    for(int dy=-(AIM_SCREEN_H-1);dy<AIM_SCREEN_H;dy++)
+        for(int dx=-(AIM_SCREEN_W-1);dx<AIM_SCREEN_W;dx++){
+            // pairs of positions on the screen with this offset
+            double weight=(double)(AIM_SCREEN_W-abs(dx))*(AIM_SCREEN_H-abs(dy)), error;
+            int iterations, b;
+            if(dx==0 && dy==0)
+                continue;
+            error=aim_method_angle(m, dx, dy, &iterations)-atan2(dy, dx)*PATH_ANGLES/(2*M_PI);
+            error=fabs(fmod(error+PATH_ANGLES*1.5, PATH_ANGLES)-PATH_ANGLES/2);
+            if(error>s->max)
+                s->max=error;
+            if(iterations>s->max_iterations)
+                s->max_iterations=iterations;
+            for(b=0;error>aim_buckets[b];b++);
+            s->buckets[b]+=weight;
+            s->total+=error*weight;
+            s->iterations+=iterations*weight;
+            s->weight+=weight;
+        }
+}
+
+static void aim_print_stats(const char *name, const char *shift, int bytes, const AimStats *s){
+    printf("%-7s %5s %5d %6.2f %6.3f %6.2f %6d  ", name, shift, bytes, s->max, s->total/s->weight, s->iterations/s->weight,
+        s->max_iterations);
+    for(int b=0;b<AIM_BUCKETS;b++)
+        printf(" %6.2f", 100*s->buckets[b]/s->weight);
+    printf("\n");
+}
+
+// Prints the error of every table size and shift, instead of the header
+void aim_report(void){
+    uint8_t *table=malloc(64*64);
+    AimMethod matrix={targeting16x16, 16, 4}, logs={NULL, 0, 0};
+    AimStats s;
+    double same=0, weight=0;
+    int worst=0;
+
+    printf("Aim table error against atan2 over every enemy/player offset of a %dx%d screen, weighted by pair count\n",
+        AIM_SCREEN_W, AIM_SCREEN_H);
+    printf("Errors in angle indices (1 = %.4f degrees), histogram in %% of the pairs\n\n", 360.0/PATH_ANGLES);
+    printf("%-7s %5s %5s %6s %6s %6s %6s  ", "table", "shift", "bytes", "max", "mean", "iters", "max it");
+    printf("  <=0.5    <=1  <=1.5    <=2    <=3    <=4     >4\n");
+    for(int size=8;size<=64;size*=2){
+        int shifts[2]={aim_bits(size), 1};
+        aim_build(size, table);
+        for(int k=0;k<2;k++){
+            AimMethod m={table, size, shifts[k]};
+            char name[24], shift[12];
+            aim_sweep(&m, &s);
+            snprintf(name, sizeof(name), "%dx%d", size, size);
+            snprintf(shift, sizeof(shift), "%d", shifts[k]);
+            aim_print_stats(name, shift, size*size, &s);
+        }
+    }
+    aim_log_build();
+    aim_sweep(&logs, &s);
+    aim_print_stats("log", "-", 512, &s);
+    printf("\nshift %d on 16x16 is aim_matrix as printed today. Emit another one with --aim=N and --aim-shift=S.\n", aim_bits(16));
+    printf("log is AimLog + AimLogAngle (--aim-log), %d steps per octave, no loop.\n", AIM_LOG_SCALE);
+
+    // how far the log tables are from aim_matrix itself
+    for(int dy=-(AIM_SCREEN_H-1);dy<AIM_SCREEN_H;dy++)
+        for(int dx=-(AIM_SCREEN_W-1);dx<AIM_SCREEN_W;dx++){
+            double w=(double)(AIM_SCREEN_W-abs(dx))*(AIM_SCREEN_H-abs(dy));
+            int it, diff;
+            if(dx==0 && dy==0)
+                continue;
+            diff=abs(aim_method_angle(&logs, dx, dy, &it)-aim_method_angle(&matrix, dx, dy, &it));
+            if(diff>64)
+                diff=128-diff;
+            if(diff>worst)
+                worst=diff;
+            if(!diff)
+                same+=w;
+            weight+=w;
+        }
+    printf("log against aim_matrix: same angle for %.2f%% of the pairs, %d angles apart at most\n", 100*same/weight, worst);
+    free(table);
+}
+
+// Prints the table chosen with --aim, its #defines and the routine that reads it
+void aim_print(int size, int shift){
+    uint8_t *table=malloc(size*size);
+
+    aim_build(size, table);
+    printf("// %dx%d Aiming Matrix for 128-Angle System, |dx| and |dy| shifted right by AIM_SHIFT until both are below AIM_SIZE\n",
+        size, size);
+    printf("// Layout: Left to Right (dx 0-%d), Top to Bottom (dy 0-%d)\n", size-1, size-1);
+    printf("#define AIM_SIZE %d\n#define AIM_SHIFT %d\n", size, shift);
+    if(emit_routed("aim_matrix")){
+        int shape[1]={size*size}, *values=malloc(size*size*sizeof(int));
+        for(int i=0;i<size*size;i++)
+            values[i]=table[i];
+        emit_table("u8", "aim_matrix", "[AIM_SIZE*AIM_SIZE]", values, shape, 1);
+        free(values);
+    }
+    else{
+        printf("const u8 aim_matrix[AIM_SIZE*AIM_SIZE] = {\n");
+        for(int dy=0;dy<size;dy++){
+            printf("    ");
+            for(int dx=0;dx<size;dx++)
+                printf("%2d,", table[dx+size*dy]);
+            printf("\n");
+        }
+        printf("};\n\n");
+    }
+    printf("// Angle (0-127) of a shot moving along (dx, dy)\n");
+    printf("static u8 AimAngle(i16 dx, i16 dy){\n");
+    printf("    u16 adx = dx < 0 ? -dx : dx, ady = dy < 0 ? -dy : dy;\n");
+    printf("    u8 angle;\n");
+    printf("    while(adx >= AIM_SIZE || ady >= AIM_SIZE){\n");
+    printf("        adx >>= AIM_SHIFT;\n");
+    printf("        ady >>= AIM_SHIFT;\n");
+    printf("    }\n");
+    printf("    angle = aim_matrix[ady*AIM_SIZE + adx];\n");
+    printf("    if(dx < 0)\n");
+    printf("        return dy < 0 ? 64 + angle : 64 - angle;\n");
+    printf("    return dy < 0 ? (128 - angle) & 127 : angle;\n");
+    printf("}\n\n");
+    free(table);
+}
+
+// Prints the log tables and the routine that reads them
+void aim_log_print(void){
+    int shape[1]={256}, values[256];
+
+    aim_log_build();
+    printf("// Constant time aim: AimLog[v] = AIM_LOG_ZERO + log2(v)*%d, AimLog[0] = 0. AimLogAngle[d] is the first quadrant\n",
+        AIM_LOG_SCALE);
+    printf("// angle of a log difference d = AimLog[|dy|] - AimLog[|dx|] >= 0. Place them on 256 bytes pages for H = page, L = index\n");
+    printf("#define AIM_LOG_ZERO %d\n", aim_log_zero);
+    for(int i=0;i<256;i++)
+        values[i]=aim_log[i];
+    emit_table("u8", "AimLog", "[256]", values, shape, 1);
+    for(int i=0;i<256;i++)
+        values[i]=aim_log_angle[i];
+    emit_table("u8", "AimLogAngle", "[256]", values, shape, 1);
+    printf("// Angle (0-127) of a shot moving along (dx, dy), |dx| and |dy| up to 255\n");
+    printf("static u8 AimAngleLog(i16 dx, i16 dy){\n");
+    printf("    u8 adx = dx < 0 ? -dx : dx, ady = dy < 0 ? -dy : dy;\n");
+    printf("    u8 ldx = AimLog[adx], ldy = AimLog[ady], angle;\n");
+    printf("    angle = ldy >= ldx ? AimLogAngle[ldy - ldx] : 32 - AimLogAngle[ldx - ldy];\n");
+    printf("    if(dx < 0)\n");
+    printf("        return dy < 0 ? 64 + angle : 64 - angle;\n");
+    printf("    return dy < 0 ? (128 - angle) & 127 : angle;\n");
+    printf("}\n\n");
+}
+
+// Prints AimRowLUT, the aim_matrix cells of every quadrant pointing at their PathAngleLUT row, or PathVelocity row of
+// the first speed, and the routine that reads it
+void aim_row_print(bool velocity){
+    const char *entry=velocity ? "PathVelocity[0] + %3d" : "PathAngleLUT[%3d]";
+
+    printf("// Row of %s of a shot aimed along (dx, dy), without the angle: AimRowLUT[quadrant][ady*16 + adx] after\n",
+        velocity ? "PathVelocity" : "PathAngleLUT");
+    printf("// the aim_matrix normalization, quadrant bit 0 dx < 0, bit 1 dy < 0. The quadrant fix-up is in the table\n");
+    if(velocity)
+        printf("// The rows are the first speed, add speed*PATH_ANGLES for the others\n");
+    printf("typedef const %s (*AimRowPtr)[2];\n", velocity ? "i16" : "i8");
+    printf("const AimRowPtr AimRowLUT[4][256]={\n");
+    for(int q=0;q<4;q++){
+        printf("    {   // dx %s 0, dy %s 0\n", q&1 ? "<" : ">=", q&2 ? "<" : ">=");
+        for(int cell=0;cell<256;cell++){
+            if(cell%8==0)
+                printf("        ");
+            printf(entry, aim_quadrant(targeting16x16[cell], q));
+            printf("%s", cell==255 ? "\n" : cell%8==7 ? ",\n" : ", ");
+        }
+        printf("    }%s\n", q!=3 ? "," : "");
+    }
+    printf("};\n\n");
+    printf("// %s row of a shot moving along (dx, dy)\n", velocity ? "PathVelocity" : "PathAngleLUT");
+    printf("static AimRowPtr AimRow(i16 dx, i16 dy){\n");
+    printf("    u16 adx = dx < 0 ? -dx : dx, ady = dy < 0 ? -dy : dy;\n");
+    printf("    while(adx >= 16 || ady >= 16){\n");
+    printf("        adx >>= 4;\n");
+    printf("        ady >>= 4;\n");
+    printf("    }\n");
+    printf("    return AimRowLUT[(dx < 0) | (dy < 0) << 1][ady*16 + adx];\n");
+    printf("}\n\n");
+}
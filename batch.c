@@ -0,0 +1,210 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "generator.h"
+
+/*
+
+Several speeds in one run. Like --fold, only the first octant of every (speed, steps) entry is stored (the first
+quadrant with --fold=quadrant): the other rows are the same deltas swapped and rotated. Each entry gets a table
+of PATH_BATCH_ROWS row pointers, and the rows themselves live in a single pool, PathRowPool. A row is only added
+to the pool when it can't be found there already (a slow speed being the prefix of a longer row, the same
+speed at fewer steps), so a row often points inside another one. PathRowDelta() rebuilds any angle:
+
+    PathRowDelta(PathRows_S_N, angle, step, &dx, &dy);
+
+Rows are added longest first, so the short ones have more chances of being found inside the long ones. Every
+entry is rebuilt for all the angles and checked against the rows computed directly before printing.
+
+*/
+
+typedef struct BatchRow{
+    int entry, angle, steps;
+    int (*deltas)[2];
+    int offset;         // first delta in the pool
+}BatchRow;
+
+static int (*pool)[2];
+static int pool_size, pool_max;
+static int *offsets;        // pool offset of every row, entry major
+static int batch_fold, batch_rows;  // fold mode and rows stored per entry
+
+// Index of the first pool delta where row is found, or -1
+static int batch_find(int (*row)[2], int steps){
+    for(int i=0;i+steps<=pool_size;i++)
+        if(!memcmp(pool[i], row, steps*sizeof(*row)))
+            return i;
+    return -1;
+}
+
+static int batch_add(int (*row)[2], int steps){
+    int offset=batch_find(row, steps);
+
+    if(offset>=0)
+        return offset;
+    if(pool_size+steps>pool_max){
+        pool_max=(pool_size+steps)*2;
+        pool=realloc(pool, pool_max*sizeof(*pool));
+    }
+    memcpy(pool[pool_size], row, steps*sizeof(*row));
+    pool_size+=steps;
+    return pool_size-steps;
+}
+
+static int batch_compare(const void *a, const void *b){
+    const BatchRow *ra=a, *rb=b;
+
+    if(ra->steps!=rb->steps)
+        return rb->steps-ra->steps;
+    if(ra->entry!=rb->entry)
+        return ra->entry-rb->entry;
+    return ra->angle-rb->angle;
+}
+
+static void batch_table_name(const BatchEntry *e, char *name, int size){
+    char speed[32];
+
+    speed_name(e->speed, speed, sizeof(speed));
+    snprintf(name, size, "PathRows_%s_%d", speed, e->steps);
+}
+
+// Delta of angle at step rebuilt from the stored rows of entry e, the way PathRowDelta() does it
+static void batch_delta(int e, int angle, int step, int *dx, int *dy){
+    int a=angle&(ANGLES_PER_QUADRANT-1), x, y;
+
+    if(batch_fold==FOLD_OCTANT && a>ANGLES_PER_QUADRANT/2){
+        x=pool[offsets[e*batch_rows+ANGLES_PER_QUADRANT-a]+step][1];
+        y=pool[offsets[e*batch_rows+ANGLES_PER_QUADRANT-a]+step][0];
+    }
+    else{
+        x=pool[offsets[e*batch_rows+a]+step][0];
+        y=pool[offsets[e*batch_rows+a]+step][1];
+    }
+    fold_rotate(angle, x, y, dx, dy);
+}
+
+static void batch_free(BatchRow *rows, int nrows){
+    for(int i=0;i<nrows;i++)
+        free(rows[i].deltas);
+    free(rows);
+}
+
+// Builds the stored rows of every entry, fills the pool, checks the rebuilt angles and prints the savings on
+// stderr. Returns false if a delta doesn't fit in an i8 or an angle isn't rebuilt
+bool batch_build(const BatchEntry *entries, int count, int fold){
+    int nrows, full=0, unique=0;
+    BatchRow *rows;
+
+    batch_fold=fold==FOLD_NONE ? FOLD_OCTANT : fold;
+    batch_rows=fold_rows(batch_fold);
+    nrows=count*batch_rows;
+    rows=calloc(nrows, sizeof(BatchRow));
+    offsets=malloc(nrows*sizeof(int));
+    for(int e=0;e<count;e++)
+        for(int i=0;i<batch_rows;i++){
+            BatchRow *r=&rows[e*batch_rows+i];
+            r->entry=e;
+            r->angle=i;
+            r->steps=entries[e].steps;
+            r->deltas=malloc(r->steps*sizeof(*r->deltas));
+            linear_row(i*2*M_PI/PATH_ANGLES, entries[e].speed, r->steps, r->deltas);
+            for(int step=0;step<r->steps;step++)
+                if(abs(r->deltas[step][0])>127 || abs(r->deltas[step][1])>127){
+                    fprintf(stderr, "batch: speed %g doesn't fit in i8 deltas\n", entries[e].speed);
+                    batch_free(rows, nrows);
+                    free(offsets);
+                    return false;
+                }
+        }
+    qsort(rows, nrows, sizeof(BatchRow), batch_compare);
+    pool_size=0;
+    for(int i=0;i<nrows;i++){
+        int before=pool_size;
+        rows[i].offset=batch_add(rows[i].deltas, rows[i].steps);
+        if(pool_size!=before)
+            unique++;
+        offsets[rows[i].entry*batch_rows+rows[i].angle]=rows[i].offset;
+    }
+    batch_free(rows, nrows);
+    for(int e=0;e<count;e++){
+        int steps=entries[e].steps, (*row)[2]=malloc(steps*sizeof(*row));
+        for(int i=0;i<PATH_ANGLES;i++){
+            linear_row(i*2*M_PI/PATH_ANGLES, entries[e].speed, steps, row);
+            for(int step=0;step<steps;step++){
+                int dx, dy;
+                batch_delta(e, i, step, &dx, &dy);
+                if(dx!=row[step][0] || dy!=row[step][1]){
+                    fprintf(stderr, "batch: speed %g angle %d step %d rebuilt as (%d, %d) instead of (%d, %d)\n",
+                        entries[e].speed, i, step, dx, dy, row[step][0], row[step][1]);
+                    free(row);
+                    return false;
+                }
+            }
+        }
+        full+=PATH_ANGLES*steps*2;
+        free(row);
+    }
+    fprintf(stderr, "batch: %d %s rows, %d stored in the pool, the others point inside it\n", nrows,
+        batch_fold==FOLD_OCTANT ? "octant" : "quadrant", unique);
+    fprintf(stderr, "batch: %d bytes as separate tables, %d as pool (%d) + row pointers (%d), %d saved\n", full,
+        pool_size*2+nrows*2, pool_size*2, nrows*2, full-pool_size*2-nrows*2);
+    return true;
+}
+
+// Prints the pool, the row pointers of every entry and PathRowDelta(). batch_build() must have been called before
+void batch_print(const BatchEntry *entries, int count){
+    int shape[2]={pool_size, 2};
+    char name[64];
+
+    printf("// Deltas shared by the PathRows tables below, first %s rows of every speed\n",
+        batch_fold==FOLD_OCTANT ? "octant" : "quadrant");
+    printf("#define PATH_ROW_POOL %d\n", pool_size);
+    printf("#define PATH_BATCH_ROWS %d\n", batch_rows);
+    emit_table("i8", "PathRowPool", "[PATH_ROW_POOL][2]", &pool[0][0], shape, 2);
+    for(int e=0;e<count;e++){
+        batch_table_name(&entries[e], name, sizeof(name));
+        printf("// %g pixels per step, %d steps: PathRowDelta(%s, angle, step, &dx, &dy)\n", entries[e].speed,
+            entries[e].steps, name);
+        printf("const i8 (* const %s[PATH_BATCH_ROWS])[2]={\n", name);
+        for(int i=0;i<batch_rows;i++){
+            if(i%8==0)
+                printf("    ");
+            printf("PathRowPool+%d", offsets[e*batch_rows+i]);
+            if(i!=batch_rows-1)
+                printf(", ");
+            if(i%8==7 || i==batch_rows-1)
+                printf("\n");
+        }
+        printf("};\n\n");
+    }
+    printf("// Delta of angle at step of a PathRows table, rebuilt from its stored rows\n");
+    printf("static void PathRowDelta(const i8 (* const *rows)[2], u8 angle, u8 step, i8 *dx, i8 *dy){\n");
+    printf("    u8 a = angle & %d;\n", ANGLES_PER_QUADRANT-1);
+    printf("    i8 x, y;\n");
+    if(batch_fold==FOLD_OCTANT){
+        printf("    if(a > %d){\n", ANGLES_PER_QUADRANT/2);
+        printf("        x = rows[%d - a][step][1];\n", ANGLES_PER_QUADRANT);
+        printf("        y = rows[%d - a][step][0];\n", ANGLES_PER_QUADRANT);
+        printf("    }\n");
+        printf("    else{\n");
+        printf("        x = rows[a][step][0];\n");
+        printf("        y = rows[a][step][1];\n");
+        printf("    }\n");
+    }
+    else{
+        printf("    x = rows[a][step][0];\n");
+        printf("    y = rows[a][step][1];\n");
+    }
+    fold_print_rotation();
+    printf("}\n\n");
+}
+
+void batch_print_externs(const BatchEntry *entries, int count){
+    char name[64];
+
+    printf("extern %si8 PathRowPool[PATH_ROW_POOL][2];\n", emit_const("PathRowPool"));
+    for(int e=0;e<count;e++){
+        batch_table_name(&entries[e], name, sizeof(name));
+        printf("extern const i8 (* const %s[PATH_BATCH_ROWS])[2];\n", name);
+    }
+}
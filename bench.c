@@ -0,0 +1,1008 @@
+#include <stdlib.h>
+#include <string.h>
+#include "generator.h"
+#include "z80.h"
+
+/*
+
+Runs the routines that read the tables on the Z80 model, with the tables generated by this run, and reports how
+many T-states they take. Each routine is checked against the C reference on every input before it is measured,
+so a wrong routine can't look fast.
+
+Memory map of the model: tables from 0x4000 (cartridge), bullets in RAM at 0xD000, stack at 0xF380.
+A bullet is 4 bytes: x, y, angle (0-127), step (0-15), followed by its origin for PathStepOffset. With --velocity
+it is 6 bytes: x and y as 8.8, angle, speed.
+
+PathStepPack reads the nibbles of --pack=nibble, PathStepOffset the PathOffset of --offsets=16 (the running sums
+of the rows, so it adds the offset to the origin and moves the origin every PATH_STEPS frames) and ShootingSpawn
+the ShootingOctant of --shooting for the ShootingCircle radii.
+
+*/
+
+#define BENCH_ROM       0x4000
+#define BENCH_PACK      0x5400      // PathAnglePacked, 8 bytes per angle
+#define BENCH_SHOOTING  0x5800      // ShootingCenter, ShootingOctant after it
+#define BENCH_SOA       0x6000      // PathAngleDX/DY, two steps per page
+#define BENCH_SOA_PAGE  0x7000      // PathAngleDX/DY, one step per page
+#define BENCH_VELOCITY  0x9000      // PathVelocity, 512 bytes per speed
+#define BENCH_AIM_ROW   0xA000      // AimRowLUT, 4 quadrants of 256 row pointers
+#define BENCH_AIM_LOG   0xB000      // AimLog, AimLogAngle on the next page
+#define BENCH_OFFSET    0xC000      // PathOffset, PATH_STEPS frames
+#define BENCH_BULLET    0xD000
+#define BENCH_STACK     0xF380
+#define BENCH_OCTANT    (ANGLES_PER_QUADRANT/2+1)
+
+enum BENCH_AIMS {BENCH_AIM_MATRIX, BENCH_AIM_LOG_TABLES, BENCH_AIM_ROWS};
+
+typedef struct BenchResult{
+    long    min, max, msx_max, total, msx_total, runs;
+}BenchResult;
+
+static Z80 cpu;
+static double bench_speeds[MAX_SPEEDS];
+static int bench_nspeeds;
+static long bench_last;         // MSX cost of the last bench_run()
+static int bench_last_reads;    // table bytes it read, everything the model reads below BENCH_BULLET
+
+static void bench_add(BenchResult *r, long t, long m1){
+    if(!r->runs || t<r->min)
+        r->min=t;
+    if(t>r->max)
+        r->max=t;
+    if(t+m1>r->msx_max)
+        r->msx_max=t+m1;
+    r->total+=t;
+    r->msx_total+=t+m1;
+    r->runs++;
+}
+
+// Calls a routine and adds its cost to r
+static void bench_run(Z80Program *p, BenchResult *r){
+    long m1=cpu.m1, watched=cpu.watched, t;
+
+    cpu.sp=BENCH_STACK;
+    t=z80_call(&cpu, p);
+    bench_last=t+cpu.m1-m1;
+    bench_last_reads=cpu.watched-watched;
+    bench_add(r, t, cpu.m1-m1);
+}
+
+static void bench_load_tables(){
+    uint8_t data[PATH_ANGLES*PATH_STEPS*2];
+    uint16_t addr=BENCH_ROM;
+
+    cpu.watch_start=BENCH_ROM;
+    cpu.watch_end=BENCH_BULLET;
+    z80_load(&cpu, "aim_matrix", addr, targeting16x16, 256);
+    addr+=256;
+    for(int i=0;i<PATH_ANGLES*PATH_STEPS*2;i++)
+        data[i]=(&path_angle_lut[0][0][0])[i];
+    z80_load(&cpu, "PathAngleLUT", addr, data, sizeof(data));
+    // --aim-row: the aim_matrix cells of every quadrant pointing at their PathAngleLUT row
+    for(int q=0;q<4;q++)
+        for(int cell=0;cell<256;cell++){
+            int row=addr+aim_quadrant(targeting16x16[cell], q)*PATH_STEPS*2;
+            cpu.mem[BENCH_AIM_ROW+(q*256+cell)*2]=row&0xFF;
+            cpu.mem[BENCH_AIM_ROW+(q*256+cell)*2+1]=row>>8;
+        }
+    z80_symbol(&cpu, "AimRowLUT", BENCH_AIM_ROW);
+    // the quadrant fold is the first rows of the full table
+    z80_load(&cpu, "PathAngleFold", addr, data, FOLD_QUADRANT_ROWS*PATH_STEPS*2);
+    addr+=sizeof(data);
+    for(int i=0;i<3*PATH_ANGLES*2;i++)
+        data[i]=(&shootingPoints[0][0][0])[i];
+    z80_load(&cpu, "ShootingCircle", addr, data, 3*PATH_ANGLES*2);
+    // --layout=soa and --layout=soa-page
+    for(int axis=0;axis<2;axis++)
+        for(int step=0;step<PATH_STEPS;step++)
+            for(int i=0;i<PATH_ANGLES;i++){
+                cpu.mem[BENCH_SOA+axis*PATH_STEPS*PATH_ANGLES+step*PATH_ANGLES+i]=path_angle_lut[i][step][axis];
+                cpu.mem[BENCH_SOA_PAGE+axis*PATH_STEPS*256+step*256+i]=path_angle_lut[i][step][axis];
+            }
+    // --velocity, or DISTANCE when it wasn't given
+    bench_nspeeds=options.nspeeds;
+    memcpy(bench_speeds, options.speeds, sizeof(bench_speeds));
+    if(!bench_nspeeds)
+        bench_speeds[bench_nspeeds++]=DISTANCE;
+    for(int s=0;s<bench_nspeeds;s++)
+        for(int i=0;i<PATH_ANGLES;i++)
+            for(int axis=0;axis<2;axis++){
+                int v=velocity_value(bench_speeds[s], i, axis), addr=BENCH_VELOCITY+s*PATH_ANGLES*4+i*4+axis*2;
+                cpu.mem[addr]=v&0xFF;
+                cpu.mem[addr+1]=(v>>8)&0xFF;
+            }
+    z80_symbol(&cpu, "PathVelocity", BENCH_VELOCITY);
+    aim_log_build();
+    z80_load(&cpu, "AimLog", BENCH_AIM_LOG, aim_log, 256);
+    z80_load(&cpu, "AimLogAngle", BENCH_AIM_LOG+256, aim_log_angle, 256);
+    // --pack=nibble: |dx| | |dy|<<2, the even step in the low nibble, the signs come from the quadrant
+    memset(data, 0, PATH_ANGLES*PATH_STEPS/2);
+    for(int i=0;i<PATH_ANGLES;i++)
+        for(int step=0;step<PATH_STEPS;step++)
+            data[(i*PATH_STEPS+step)/2]|=(abs(path_angle_lut[i][step][0])|abs(path_angle_lut[i][step][1])<<2)<<(step&1)*4;
+    z80_load(&cpu, "PathAnglePacked", BENCH_PACK, data, PATH_ANGLES*PATH_STEPS/2);
+    // --offsets=16: the running sums of the rows
+    for(int i=0;i<PATH_ANGLES;i++)
+        for(int step=0, x=0, y=0;step<PATH_STEPS;step++){
+            x+=path_angle_lut[i][step][0];
+            y+=path_angle_lut[i][step][1];
+            data[(i*PATH_STEPS+step)*2]=x;
+            data[(i*PATH_STEPS+step)*2+1]=y;
+        }
+    z80_load(&cpu, "PathOffset", BENCH_OFFSET, data, PATH_ANGLES*PATH_STEPS*2);
+    // --shooting=8,16,32: the ShootingCircle points as distances from the center of the sprite
+    for(int r=0;r<3;r++){
+        data[r]=(8<<r)-2;
+        for(int k=0;k<BENCH_OCTANT;k++){
+            data[3+(r*BENCH_OCTANT+k)*2]=shootingPoints[r][k][0]-data[r];
+            data[3+(r*BENCH_OCTANT+k)*2+1]=shootingPoints[r][k][1]-data[r];
+        }
+    }
+    z80_load(&cpu, "ShootingCenter", BENCH_SHOOTING, data, 3);
+    z80_load(&cpu, "ShootingOctant", BENCH_SHOOTING+3, data+3, 3*BENCH_OCTANT*2);
+}
+
+// D = |player x - enemy x|, E = |player y - enemy y|, L = quadrant: bit 0 dx<0, bit 1 dy<0
+static void bench_aim_abs(Z80Program *p){
+    z_ldn(p, R_L, 0);
+    z_ld(p, R_A, R_D);
+    z_alu(p, ALU_SUB, R_B);
+    z_jr(p, CC_NC, ".dx");
+    z_simple(p, OP_NEG);
+    z_inc(p, R_L);
+    z_label(p, ".dx");
+    z_ld(p, R_D, R_A);
+    z_ld(p, R_A, R_E);
+    z_alu(p, ALU_SUB, R_C);
+    z_jr(p, CC_NC, ".dy");
+    z_simple(p, OP_NEG);
+    z_inc(p, R_L);
+    z_inc(p, R_L);
+    z_label(p, ".dy");
+    z_ld(p, R_E, R_A);
+}
+
+// Returns, or jumps to done when the routine goes on after the aim
+static void bench_aim_done(Z80Program *p, const char *done){
+    if(done)
+        z_jr(p, CC_ALWAYS, done);
+    else
+        z_ret(p, CC_ALWAYS);
+}
+
+// Fixes the first quadrant angle in B up with the quadrant in C, as described at the top of paths.c, and returns
+// or goes on at done with the angle in A
+static void bench_aim_quadrant(Z80Program *p, const char *done){
+    z_ld(p, R_A, R_C);
+    z_alun(p, ALU_CP, 1);
+    z_jr(p, CC_Z, ".q1");
+    z_alun(p, ALU_CP, 2);
+    z_jr(p, CC_Z, ".q2");
+    z_alun(p, ALU_CP, 3);
+    z_jr(p, CC_Z, ".q3");
+    z_ld(p, R_A, R_B);
+    bench_aim_done(p, done);
+    z_label(p, ".q1");           // dx<0, dy>=0: 64-angle
+    z_ldn(p, R_A, 64);
+    z_alu(p, ALU_SUB, R_B);
+    bench_aim_done(p, done);
+    z_label(p, ".q2");           // dx>=0, dy<0: (128-angle)&127
+    z_alu(p, ALU_XOR, R_A);
+    z_alu(p, ALU_SUB, R_B);
+    z_alun(p, ALU_AND, 127);
+    bench_aim_done(p, done);
+    z_label(p, ".q3");           // dx<0, dy<0: 64+angle
+    z_ldn(p, R_A, 64);
+    z_alu(p, ALU_ADD, R_B);
+    if(!done)
+        z_ret(p, CC_ALWAYS);
+}
+
+// |dx| in D and |dy| in E shifted right by 4 until both are below 16, then A = |dy|*16 + |dx|
+static void bench_aim_cell(Z80Program *p){
+    z_label(p, ".norm");
+    z_ld(p, R_A, R_D);
+    z_alu(p, ALU_OR, R_E);
+    z_alun(p, ALU_AND, 0xF0);
+    z_jr(p, CC_Z, ".lookup");
+    for(int i=0;i<4;i++){
+        z_shift(p, SH_SRL, R_D);
+        z_shift(p, SH_SRL, R_E);
+    }
+    z_jr(p, CC_ALWAYS, ".norm");
+    z_label(p, ".lookup");
+    z_ld(p, R_A, R_E);
+    for(int i=0;i<4;i++)
+        z_alu(p, ALU_ADD, R_A);
+    z_alu(p, ALU_OR, R_D);
+}
+
+// aim_matrix read and quadrant fix-up, after bench_aim_abs()
+static void bench_aim_matrix(Z80Program *p, const char *done){
+    bench_aim_cell(p);
+    z_ld(p, R_C, R_L);
+    z_ld(p, R_L, R_A);
+    z_ldn(p, R_H, 0);
+    z_ld16(p, RP_DE, 0, "aim_matrix");
+    z_add16(p, RP_DE);
+    z_ld(p, R_B, R_HLI);
+    bench_aim_quadrant(p, done);
+}
+
+// In: B = enemy x, C = enemy y, D = player x, E = player y. Out: A = angle 0-127
+static Z80Program *bench_aim_routine(){
+    Z80Program *p=z80_new("AimShot");
+
+    bench_aim_abs(p);
+    bench_aim_matrix(p, NULL);
+    return p;
+}
+
+// Same, then HL = PathAngleLUT row of the angle: the three steps an aimed shot takes today
+static Z80Program *bench_aim_chain_routine(){
+    Z80Program *p=z80_new("AimShotChain");
+
+    bench_aim_abs(p);
+    bench_aim_matrix(p, ".row");
+    z_label(p, ".row");
+    z_ld(p, R_L, R_A);
+    z_ldn(p, R_H, 0);
+    for(int i=1;i<PATH_STEPS*2;i<<=1)
+        z_add16(p, RP_HL);
+    z_ld16(p, RP_DE, 0, "PathAngleLUT");
+    z_add16(p, RP_DE);
+    z_ret(p, CC_ALWAYS);
+    return p;
+}
+
+// Same, HL = PathAngleLUT row read from AimRowLUT[quadrant][cell], no angle in between
+static Z80Program *bench_aim_row_routine(){
+    Z80Program *p=z80_new("AimShotRow");
+
+    bench_aim_abs(p);
+    bench_aim_cell(p);
+    z_ld(p, R_H, R_L);              // HL = AimRowLUT + (quadrant*256 + cell)*2
+    z_ld(p, R_L, R_A);
+    z_add16(p, RP_HL);
+    z_ld16(p, RP_DE, 0, "AimRowLUT");
+    z_add16(p, RP_DE);
+    z_ld(p, R_A, R_HLI);
+    z_inc16(p, RP_HL);
+    z_ld(p, R_H, R_HLI);
+    z_ld(p, R_L, R_A);
+    z_ret(p, CC_ALWAYS);
+    return p;
+}
+
+// In: B = enemy x, C = enemy y, D = player x, E = player y. Out: A = angle 0-127, with AimLog/AimLogAngle
+static Z80Program *bench_aim_log_routine(){
+    Z80Program *p=z80_new("AimShotLog");
+
+    bench_aim_abs(p);
+    z_ld(p, R_C, R_L);
+    z_ld16(p, RP_HL, 0, "AimLog");
+    z_ld(p, R_L, R_E);
+    z_ld(p, R_A, R_HLI);            // A = log |dy|
+    z_ld(p, R_L, R_D);
+    z_alu(p, ALU_SUB, R_HLI);       // - log |dx|
+    z_inc(p, R_H);                  // AimLogAngle is the next page
+    z_jr(p, CC_C, "AimShotLog_flat");
+    z_ld(p, R_L, R_A);
+    z_ld(p, R_B, R_HLI);
+    z_jr(p, CC_ALWAYS, "AimShotLog_fix");
+    z_label(p, "AimShotLog_flat");  // |dx| > |dy|: 32 - AimLogAngle[-d]
+    z_simple(p, OP_NEG);
+    z_ld(p, R_L, R_A);
+    z_ldn(p, R_A, 32);
+    z_alu(p, ALU_SUB, R_HLI);
+    z_ld(p, R_B, R_A);
+    z_label(p, "AimShotLog_fix");
+    bench_aim_quadrant(p, NULL);
+    return p;
+}
+
+// Reads the bullet at HL and leaves angle in B, step in C, with the step already advanced in the bullet
+static void bench_read_bullet(Z80Program *p){
+    z_push(p, RP_HL);
+    z_inc16(p, RP_HL);
+    z_inc16(p, RP_HL);
+    z_ld(p, R_B, R_HLI);
+    z_inc16(p, RP_HL);
+    z_ld(p, R_C, R_HLI);
+    z_ld(p, R_A, R_C);
+    z_inc(p, R_A);
+    z_alun(p, ALU_AND, PATH_STEPS-1);
+    z_ld(p, R_HLI, R_A);
+}
+
+// HL = table + (angle in A)*PATH_STEPS*2 + (step in C)*2
+static void bench_row_address(Z80Program *p, const char *table){
+    z_ld(p, R_L, R_A);
+    z_ldn(p, R_H, 0);
+    for(int i=1;i<PATH_STEPS*2;i<<=1)
+        z_add16(p, RP_HL);
+    z_ld(p, R_A, R_C);
+    z_alu(p, ALU_ADD, R_A);
+    z_alu(p, ALU_OR, R_L);
+    z_ld(p, R_L, R_A);
+    z_ld16(p, RP_DE, 0, table);
+    z_add16(p, RP_DE);
+}
+
+// Adds E to the bullet x and D to the bullet y, the bullet pointer is on the stack
+static void bench_move_bullet(Z80Program *p){
+    z_pop(p, RP_HL);
+    z_ld(p, R_A, R_HLI);
+    z_alu(p, ALU_ADD, R_E);
+    z_ld(p, R_HLI, R_A);
+    z_inc16(p, RP_HL);
+    z_ld(p, R_A, R_HLI);
+    z_alu(p, ALU_ADD, R_D);
+    z_ld(p, R_HLI, R_A);
+    z_ret(p, CC_ALWAYS);
+}
+
+// In: HL = bullet. Moves it with PathAngleLUT and advances its step
+static Z80Program *bench_step_routine(){
+    Z80Program *p=z80_new("PathStep");
+
+    bench_read_bullet(p);
+    z_ld(p, R_A, R_B);
+    bench_row_address(p, "PathAngleLUT");
+    z_ld(p, R_E, R_HLI);
+    z_inc16(p, RP_HL);
+    z_ld(p, R_D, R_HLI);
+    bench_move_bullet(p);
+    return p;
+}
+
+// Same as PathStep, reading the quadrant folded table and rotating the delta
+static Z80Program *bench_step_fold_routine(){
+    Z80Program *p=z80_new("PathStepFold");
+
+    bench_read_bullet(p);
+    z_ld(p, R_A, R_B);
+    z_alun(p, ALU_AND, ANGLES_PER_QUADRANT-1);
+    bench_row_address(p, "PathAngleFold");
+    z_ld(p, R_E, R_HLI);            // E = x
+    z_inc16(p, RP_HL);
+    z_ld(p, R_D, R_HLI);            // D = y
+    z_ld(p, R_A, R_B);              // A = quadrant
+    z_simple(p, OP_RLCA);
+    z_simple(p, OP_RLCA);
+    z_simple(p, OP_RLCA);
+    z_alun(p, ALU_AND, 3);
+    z_jr(p, CC_Z, "PathStepFold_move");
+    z_dec(p, R_A);
+    z_jr(p, CC_Z, "PathStepFold_q1");
+    z_dec(p, R_A);
+    z_jr(p, CC_Z, "PathStepFold_q2");
+    z_ld(p, R_A, R_E);              // quadrant 3: (y, -x)
+    z_simple(p, OP_NEG);
+    z_ld(p, R_E, R_D);
+    z_ld(p, R_D, R_A);
+    z_jr(p, CC_ALWAYS, "PathStepFold_move");
+    z_label(p, "PathStepFold_q1");  // quadrant 1: (-y, x)
+    z_ld(p, R_A, R_D);
+    z_simple(p, OP_NEG);
+    z_ld(p, R_D, R_E);
+    z_ld(p, R_E, R_A);
+    z_jr(p, CC_ALWAYS, "PathStepFold_move");
+    z_label(p, "PathStepFold_q2");  // quadrant 2: (-x, -y)
+    z_ld(p, R_A, R_E);
+    z_simple(p, OP_NEG);
+    z_ld(p, R_E, R_A);
+    z_ld(p, R_A, R_D);
+    z_simple(p, OP_NEG);
+    z_ld(p, R_D, R_A);
+    z_label(p, "PathStepFold_move");
+    bench_move_bullet(p);
+    return p;
+}
+
+// Same as PathStep, reading PathAngleDX/DY of --layout=soa: H = page + step/2, L = (step&1)*128 + angle
+static Z80Program *bench_step_soa_routine(){
+    Z80Program *p=z80_new("PathStepSoA");
+
+    bench_read_bullet(p);
+    z_ld(p, R_A, R_C);
+    z_simple(p, OP_RRCA);
+    z_alun(p, ALU_AND, 0x80);
+    z_alu(p, ALU_OR, R_B);
+    z_ld(p, R_L, R_A);
+    z_ld(p, R_A, R_C);
+    z_simple(p, OP_RRCA);
+    z_alun(p, ALU_AND, 0x7F);
+    z_alun(p, ALU_ADD, BENCH_SOA>>8);
+    z_ld(p, R_H, R_A);
+    z_ld(p, R_E, R_HLI);
+    z_alun(p, ALU_ADD, PATH_STEPS*PATH_ANGLES>>8);
+    z_ld(p, R_H, R_A);
+    z_ld(p, R_D, R_HLI);
+    bench_move_bullet(p);
+    return p;
+}
+
+// Same as PathStep, reading PathAngleDX/DY of --layout=soa-page: H = page + step, L = angle
+static Z80Program *bench_step_soa_page_routine(){
+    Z80Program *p=z80_new("PathStepSoAPage");
+
+    bench_read_bullet(p);
+    z_ld(p, R_L, R_B);
+    z_ld(p, R_A, R_C);
+    z_alun(p, ALU_ADD, BENCH_SOA_PAGE>>8);
+    z_ld(p, R_H, R_A);
+    z_ld(p, R_E, R_HLI);
+    z_alun(p, ALU_ADD, PATH_STEPS);
+    z_ld(p, R_H, R_A);
+    z_ld(p, R_D, R_HLI);
+    bench_move_bullet(p);
+    return p;
+}
+
+// Same as PathStep, reading the nibbles of --pack=nibble: HL = PathAnglePacked + angle*8 + step/2, the odd step in
+// the high nibble, and the signs of the quadrant: (+, +), (-, +), (-, -), (+, -)
+static Z80Program *bench_step_pack_routine(){
+    Z80Program *p=z80_new("PathStepPack");
+
+    bench_read_bullet(p);
+    z_ld(p, R_L, R_B);
+    z_ldn(p, R_H, 0);
+    for(int i=1;i<PATH_STEPS/2;i<<=1)
+        z_add16(p, RP_HL);
+    z_ld(p, R_A, R_C);
+    z_simple(p, OP_RRCA);
+    z_alun(p, ALU_AND, PATH_STEPS/2-1);
+    z_alu(p, ALU_OR, R_L);
+    z_ld(p, R_L, R_A);
+    z_ld16(p, RP_DE, 0, "PathAnglePacked");
+    z_add16(p, RP_DE);
+    z_ld(p, R_A, R_HLI);
+    z_bit(p, 0, R_C);
+    z_jr(p, CC_Z, "PathStepPack_even");
+    for(int i=0;i<4;i++)
+        z_simple(p, OP_RRCA);
+    z_label(p, "PathStepPack_even");
+    z_ld(p, R_D, R_A);
+    z_alun(p, ALU_AND, 3);
+    z_ld(p, R_E, R_A);              // E = |x|
+    z_ld(p, R_A, R_D);
+    z_simple(p, OP_RRCA);
+    z_simple(p, OP_RRCA);
+    z_alun(p, ALU_AND, 3);
+    z_ld(p, R_D, R_A);              // D = |y|
+    z_ld(p, R_A, R_B);              // A = quadrant*32
+    z_alun(p, ALU_AND, 3*ANGLES_PER_QUADRANT);
+    z_jr(p, CC_Z, "PathStepPack_move");
+    z_alun(p, ALU_CP, 2*ANGLES_PER_QUADRANT);
+    z_jr(p, CC_C, "PathStepPack_x");
+    z_ld(p, R_A, R_D);              // quadrants 2 and 3: -y
+    z_simple(p, OP_NEG);
+    z_ld(p, R_D, R_A);
+    z_ld(p, R_A, R_B);
+    z_alun(p, ALU_AND, 3*ANGLES_PER_QUADRANT);
+    z_alun(p, ALU_CP, 3*ANGLES_PER_QUADRANT);
+    z_jr(p, CC_Z, "PathStepPack_move");
+    z_label(p, "PathStepPack_x");   // quadrants 1 and 2: -x
+    z_ld(p, R_A, R_E);
+    z_simple(p, OP_NEG);
+    z_ld(p, R_E, R_A);
+    z_label(p, "PathStepPack_move");
+    bench_move_bullet(p);
+    return p;
+}
+
+// In: HL = bullet with its origin after it. Puts it at origin + PathOffset[angle][step] of --offsets=16, and moves
+// the origin there after the last step
+static Z80Program *bench_step_offset_routine(){
+    Z80Program *p=z80_new("PathStepOffset");
+
+    bench_read_bullet(p);
+    z_ld(p, R_A, R_B);
+    bench_row_address(p, "PathOffset");
+    z_ld(p, R_E, R_HLI);
+    z_inc16(p, RP_HL);
+    z_ld(p, R_D, R_HLI);
+    z_pop(p, RP_HL);
+    z_push(p, RP_HL);
+    for(int i=0;i<4;i++)
+        z_inc16(p, RP_HL);
+    z_ld(p, R_A, R_HLI);            // E = origin x + offset
+    z_alu(p, ALU_ADD, R_E);
+    z_ld(p, R_E, R_A);
+    z_inc16(p, RP_HL);
+    z_ld(p, R_A, R_HLI);            // D = origin y + offset
+    z_alu(p, ALU_ADD, R_D);
+    z_ld(p, R_D, R_A);
+    z_ld(p, R_A, R_C);
+    z_alun(p, ALU_CP, PATH_STEPS-1);
+    z_jr(p, CC_NZ, "PathStepOffset_store");
+    z_ld(p, R_HLI, R_D);
+    z_dec16(p, RP_HL);
+    z_ld(p, R_HLI, R_E);
+    z_label(p, "PathStepOffset_store");
+    z_pop(p, RP_HL);
+    z_ld(p, R_HLI, R_E);
+    z_inc16(p, RP_HL);
+    z_ld(p, R_HLI, R_D);
+    z_ret(p, CC_ALWAYS);
+    return p;
+}
+
+// In: HL = 6 bytes bullet. Adds PathVelocity[speed][angle] to its 8.8 position
+static Z80Program *bench_step_velocity_routine(){
+    Z80Program *p=z80_new("PathStepVelocity");
+
+    z_push(p, RP_HL);
+    for(int i=0;i<4;i++)
+        z_inc16(p, RP_HL);
+    z_ld(p, R_A, R_HLI);            // angle
+    z_inc16(p, RP_HL);
+    z_ld(p, R_B, R_HLI);            // speed
+    z_ld(p, R_L, R_A);              // HL = PathVelocity + speed*512 + angle*4
+    z_ldn(p, R_H, 0);
+    z_add16(p, RP_HL);
+    z_add16(p, RP_HL);
+    z_ld(p, R_A, R_B);
+    z_alu(p, ALU_ADD, R_A);
+    z_alu(p, ALU_ADD, R_H);
+    z_ld(p, R_H, R_A);
+    z_ld16(p, RP_DE, 0, "PathVelocity");
+    z_add16(p, RP_DE);
+    z_ld(p, R_C, R_HLI);            // BC = vx
+    z_inc16(p, RP_HL);
+    z_ld(p, R_B, R_HLI);
+    z_inc16(p, RP_HL);
+    z_ld(p, R_E, R_HLI);            // DE = vy
+    z_inc16(p, RP_HL);
+    z_ld(p, R_D, R_HLI);
+    z_pop(p, RP_HL);
+    z_ld(p, R_A, R_HLI);
+    z_alu(p, ALU_ADD, R_C);
+    z_ld(p, R_HLI, R_A);
+    z_inc16(p, RP_HL);
+    z_ld(p, R_A, R_HLI);
+    z_alu(p, ALU_ADC, R_B);
+    z_ld(p, R_HLI, R_A);
+    z_inc16(p, RP_HL);
+    z_ld(p, R_A, R_HLI);
+    z_alu(p, ALU_ADD, R_E);
+    z_ld(p, R_HLI, R_A);
+    z_inc16(p, RP_HL);
+    z_ld(p, R_A, R_HLI);
+    z_alu(p, ALU_ADC, R_D);
+    z_ld(p, R_HLI, R_A);
+    z_ret(p, CC_ALWAYS);
+    return p;
+}
+
+// In: HL = bullet, B = enemy x, C = enemy y, D = radius (0-2), E = angle. Spawns the bullet on the ShootingCircle
+static Z80Program *bench_spawn_routine(){
+    Z80Program *p=z80_new("SpawnBullet");
+
+    z_inc16(p, RP_HL);
+    z_inc16(p, RP_HL);
+    z_ld(p, R_HLI, R_E);
+    z_inc16(p, RP_HL);
+    z_ldn(p, R_HLI, 0);
+    z_dec16(p, RP_HL);
+    z_dec16(p, RP_HL);
+    z_dec16(p, RP_HL);
+    z_push(p, RP_HL);
+    z_ld(p, R_A, R_E);              // ShootingCircle rows are 256 bytes: H = radius, L = angle*2
+    z_alu(p, ALU_ADD, R_A);
+    z_ld(p, R_L, R_A);
+    z_ld(p, R_H, R_D);
+    z_ld16(p, RP_DE, 0, "ShootingCircle");
+    z_add16(p, RP_DE);
+    z_ld(p, R_A, R_HLI);
+    z_alu(p, ALU_ADD, R_B);
+    z_ld(p, R_B, R_A);
+    z_inc16(p, RP_HL);
+    z_ld(p, R_A, R_HLI);
+    z_alu(p, ALU_ADD, R_C);
+    z_ld(p, R_C, R_A);
+    z_pop(p, RP_HL);
+    z_ld(p, R_HLI, R_B);
+    z_inc16(p, RP_HL);
+    z_ld(p, R_HLI, R_C);
+    z_ret(p, CC_ALWAYS);
+    return p;
+}
+
+// Same as SpawnBullet, rebuilding the point from ShootingOctant the way ShootingSpawn() does it. E keeps the sign
+// of x in bit 0, the one of y in bit 1 and the swap of the octant in bit 2
+static Z80Program *bench_spawn_octant_routine(){
+    Z80Program *p=z80_new("ShootingSpawn");
+
+    z_inc16(p, RP_HL);
+    z_inc16(p, RP_HL);
+    z_ld(p, R_HLI, R_E);
+    z_inc16(p, RP_HL);
+    z_ldn(p, R_HLI, 0);
+    z_dec16(p, RP_HL);
+    z_dec16(p, RP_HL);
+    z_dec16(p, RP_HL);
+    z_push(p, RP_HL);
+    z_ld16(p, RP_HL, 0, "ShootingCenter");     // B, C += ShootingCenter[radius]
+    z_ld(p, R_A, R_L);
+    z_alu(p, ALU_ADD, R_D);
+    z_ld(p, R_L, R_A);
+    z_ld(p, R_A, R_H);
+    z_alun(p, ALU_ADC, 0);
+    z_ld(p, R_H, R_A);
+    z_ld(p, R_A, R_HLI);
+    z_ld(p, R_H, R_A);
+    z_alu(p, ALU_ADD, R_B);
+    z_ld(p, R_B, R_A);
+    z_ld(p, R_A, R_H);
+    z_alu(p, ALU_ADD, R_C);
+    z_ld(p, R_C, R_A);
+    z_ld(p, R_A, R_D);              // D = radius*BENCH_OCTANT*2
+    z_alu(p, ALU_ADD, R_A);
+    z_ld(p, R_D, R_A);
+    for(int i=0;i<4;i++)
+        z_alu(p, ALU_ADD, R_A);
+    z_alu(p, ALU_ADD, R_D);
+    z_ld(p, R_D, R_A);
+    z_ld(p, R_A, R_E);              // A = k
+    z_alun(p, ALU_AND, PATH_ANGLES-1);
+    z_ldn(p, R_E, 0);
+    z_alun(p, ALU_CP, 33);
+    z_jr(p, CC_C, "ShootingSpawn_octant");
+    z_alun(p, ALU_CP, 65);
+    z_jr(p, CC_NC, "ShootingSpawn_low");
+    z_simple(p, OP_NEG);            // 33-64: 64 - angle, -x
+    z_alun(p, ALU_ADD, 64);
+    z_ldn(p, R_E, 1);
+    z_jr(p, CC_ALWAYS, "ShootingSpawn_octant");
+    z_label(p, "ShootingSpawn_low");
+    z_alun(p, ALU_CP, 97);
+    z_jr(p, CC_NC, "ShootingSpawn_q2");
+    z_alun(p, ALU_SUB, 64);         // 65-96: angle - 64, -x, -y
+    z_ldn(p, R_E, 3);
+    z_jr(p, CC_ALWAYS, "ShootingSpawn_octant");
+    z_label(p, "ShootingSpawn_q2"); // 97-127: 128 - angle, -y
+    z_simple(p, OP_NEG);
+    z_alun(p, ALU_ADD, 128);
+    z_ldn(p, R_E, 2);
+    z_label(p, "ShootingSpawn_octant");
+    z_alun(p, ALU_CP, ANGLES_PER_QUADRANT/2+1);
+    z_jr(p, CC_C, "ShootingSpawn_row");
+    z_simple(p, OP_NEG);
+    z_alun(p, ALU_ADD, ANGLES_PER_QUADRANT);
+    z_set(p, 2, R_E);
+    z_label(p, "ShootingSpawn_row");
+    z_alu(p, ALU_ADD, R_A);         // HL = ShootingOctant + radius*BENCH_OCTANT*2 + k*2
+    z_alu(p, ALU_ADD, R_D);
+    z_ld(p, R_L, R_A);
+    z_ldn(p, R_H, 0);
+    z_ld(p, R_A, R_E);
+    z_simple(p, OP_EXAF);
+    z_ld16(p, RP_DE, 0, "ShootingOctant");
+    z_add16(p, RP_DE);
+    z_ld(p, R_E, R_HLI);            // E = |x|, D = |y|
+    z_inc16(p, RP_HL);
+    z_ld(p, R_D, R_HLI);
+    z_simple(p, OP_EXAF);
+    z_ld(p, R_H, R_A);
+    z_bit(p, 2, R_H);
+    z_jr(p, CC_Z, "ShootingSpawn_x");
+    z_ld(p, R_A, R_E);
+    z_ld(p, R_E, R_D);
+    z_ld(p, R_D, R_A);
+    z_label(p, "ShootingSpawn_x");
+    z_ld(p, R_A, R_B);
+    z_bit(p, 0, R_H);
+    z_jr(p, CC_Z, "ShootingSpawn_xadd");
+    z_alu(p, ALU_SUB, R_E);
+    z_jr(p, CC_ALWAYS, "ShootingSpawn_y");
+    z_label(p, "ShootingSpawn_xadd");
+    z_alu(p, ALU_ADD, R_E);
+    z_label(p, "ShootingSpawn_y");
+    z_ld(p, R_B, R_A);
+    z_ld(p, R_A, R_C);
+    z_bit(p, 1, R_H);
+    z_jr(p, CC_Z, "ShootingSpawn_yadd");
+    z_alu(p, ALU_SUB, R_D);
+    z_jr(p, CC_ALWAYS, "ShootingSpawn_store");
+    z_label(p, "ShootingSpawn_yadd");
+    z_alu(p, ALU_ADD, R_D);
+    z_label(p, "ShootingSpawn_store");
+    z_ld(p, R_C, R_A);
+    z_pop(p, RP_HL);
+    z_ld(p, R_HLI, R_B);
+    z_inc16(p, RP_HL);
+    z_ld(p, R_HLI, R_C);
+    z_ret(p, CC_ALWAYS);
+    return p;
+}
+
+// Aim routines, in the order of the report. The ones that give a row are checked against the row of the angle
+static const struct{
+    Z80Program  *(*build)(void);
+    int         check;
+}bench_aims[]={
+    {bench_aim_routine,         BENCH_AIM_MATRIX},
+    {bench_aim_log_routine,     BENCH_AIM_LOG_TABLES},
+    {bench_aim_chain_routine,   BENCH_AIM_ROWS},
+    {bench_aim_row_routine,     BENCH_AIM_ROWS},
+};
+
+// Bullet steppers, all checked against path_angle_lut and compared in the report. The origin ones keep the origin
+// of the bullet after it
+static const struct{
+    Z80Program  *(*build)(void);
+    const char  *table;
+    bool        origin;
+}bench_steppers[]={
+    {bench_step_routine,            "PathAngleLUT",                 false},
+    {bench_step_fold_routine,       "PathAngleFold",                false},
+    {bench_step_soa_routine,        "PathAngleDX/DY (soa)",         false},
+    {bench_step_soa_page_routine,   "PathAngleDX/DY (soa-page)",    false},
+    {bench_step_pack_routine,       "PathAnglePacked",              false},
+    {bench_step_offset_routine,     "PathOffset",                   true},
+};
+
+// Spawn routines, both checked against ShootingCircle
+static Z80Program *(*const bench_spawners[])(void)={bench_spawn_routine, bench_spawn_octant_routine};
+
+#define BENCH_AIM_ROUTINES  (int)(sizeof(bench_aims)/sizeof(bench_aims[0]))
+#define BENCH_STEPPERS      (int)(sizeof(bench_steppers)/sizeof(bench_steppers[0]))
+#define BENCH_SPAWNERS      (int)(sizeof(bench_spawners)/sizeof(bench_spawners[0]))
+
+// The routines of bench_open(), what they cost on the inputs they were checked with, and the MSX cost of the
+// steps and spawns by input for bench_step_call()/bench_spawn_call()
+static Z80Program *bench_aim_programs[BENCH_AIM_ROUTINES], *bench_step_programs[BENCH_STEPPERS];
+static Z80Program *bench_spawn_programs[BENCH_SPAWNERS], *bench_velocity_program;
+static BenchResult r_aims[BENCH_AIM_ROUTINES], r_steps[BENCH_STEPPERS], r_spawns[BENCH_SPAWNERS], r_velocity;
+static BenchCall bench_step_costs[BENCH_STEPPERS+1][PATH_ANGLES][PATH_STEPS], bench_spawn_costs[BENCH_SPAWNERS][3][PATH_ANGLES];
+
+// Runs an aim routine from the enemy at (ex, ey) to the player at (px, py)
+static void bench_aim_run(Z80Program *p, BenchResult *r, int ex, int ey, int px, int py){
+    cpu.r[R_B]=ex;
+    cpu.r[R_C]=ey;
+    cpu.r[R_D]=px;
+    cpu.r[R_E]=py;
+    bench_run(p, r);
+}
+
+// Checks an aim routine against aim_matrix read with the shift loop, or against the log tables. An aim to a row
+// must give the address of the PathAngleLUT row of the aim_matrix angle
+static bool bench_aim(Z80Program *p, BenchResult *r, int aim){
+    static const int players[][2]={{128, 160}, {128, 96}, {16, 176}, {240, 8}};
+
+    for(int i=0;i<4;i++)
+        for(int ey=0;ey<192;ey+=2)
+            for(int ex=0;ex<256;ex+=2){
+                int px=players[i][0], py=players[i][1], expected, got;
+                bench_aim_run(p, r, ex, ey, px, py);
+                if(aim==BENCH_AIM_LOG_TABLES)
+                    expected=aim_log_angle_of(px-ex, py-ey);
+                else
+                    expected=aim_angle(targeting16x16, 16, 4, px-ex, py-ey, NULL);
+                got=cpu.r[R_A];
+                if(aim==BENCH_AIM_ROWS){
+                    expected=BENCH_ROM+256+expected*PATH_STEPS*2;
+                    got=z80_pair(&cpu, RP_HL);
+                }
+                if(got!=expected){
+                    fprintf(stderr, "bench: %s from (%d, %d) to (%d, %d) gives %d, expected %d\n", p->name, ex, ey, px, py,
+                        got, expected);
+                    return false;
+                }
+            }
+    return true;
+}
+
+// The origin of the bullet is where the steps before this one started, and moves to the bullet after the last step
+static bool bench_step(Z80Program *p, BenchResult *r, BenchCall (*costs)[PATH_STEPS], bool origin){
+    for(int angle=0;angle<PATH_ANGLES;angle++)
+        for(int step=0, ox=100, oy=90;step<PATH_STEPS;step++){
+            uint8_t *b=cpu.mem+BENCH_BULLET;
+            int x=100, y=90;
+            b[0]=x;
+            b[1]=y;
+            b[2]=angle;
+            b[3]=step;
+            b[4]=ox;
+            b[5]=oy;
+            z80_set_pair(&cpu, RP_HL, BENCH_BULLET);
+            bench_run(p, r);
+            costs[angle][step]=(BenchCall){bench_last, bench_last_reads};
+            x=(x+path_angle_lut[angle][step][0])&0xFF;
+            y=(y+path_angle_lut[angle][step][1])&0xFF;
+            ox=(ox-path_angle_lut[angle][step][0])&0xFF;
+            oy=(oy-path_angle_lut[angle][step][1])&0xFF;
+            if(origin && step==PATH_STEPS-1 && (b[4]!=x || b[5]!=y)){
+                fprintf(stderr, "bench: %s angle %d moves the origin to (%d, %d), expected (%d, %d)\n", p->name, angle,
+                    b[4], b[5], x, y);
+                return false;
+            }
+            if(b[0]!=x || b[1]!=y || b[2]!=angle || b[3]!=((step+1)&(PATH_STEPS-1))){
+                fprintf(stderr, "bench: %s angle %d step %d gives (%d, %d) step %d, expected (%d, %d)\n", p->name, angle, step,
+                    b[0], b[1], b[3], x, y);
+                return false;
+            }
+        }
+    return true;
+}
+
+// The costs of the first speed go to the last row of bench_step_costs, the same for every step
+static bool bench_velocity(Z80Program *p, BenchResult *r){
+    for(int s=0;s<bench_nspeeds;s++)
+        for(int angle=0;angle<PATH_ANGLES;angle++){
+            uint8_t *b=cpu.mem+BENCH_BULLET;
+            int x=0x6480, y=0x5A80;
+            b[0]=x;
+            b[1]=x>>8;
+            b[2]=y;
+            b[3]=y>>8;
+            b[4]=angle;
+            b[5]=s;
+            z80_set_pair(&cpu, RP_HL, BENCH_BULLET);
+            bench_run(p, r);
+            if(!s)
+                for(int step=0;step<PATH_STEPS;step++)
+                    bench_step_costs[BENCH_STEPPERS][angle][step]=(BenchCall){bench_last, bench_last_reads};
+            x=(x+velocity_value(bench_speeds[s], angle, 0))&0xFFFF;
+            y=(y+velocity_value(bench_speeds[s], angle, 1))&0xFFFF;
+            if((b[0]|b[1]<<8)!=x || (b[2]|b[3]<<8)!=y){
+                fprintf(stderr, "bench: %s speed %g angle %d gives (0x%04X, 0x%04X), expected (0x%04X, 0x%04X)\n", p->name,
+                    bench_speeds[s], angle, b[0]|b[1]<<8, b[2]|b[3]<<8, x, y);
+                return false;
+            }
+        }
+    return true;
+}
+
+static bool bench_spawn(Z80Program *p, BenchResult *r, BenchCall (*costs)[PATH_ANGLES]){
+    for(int radius=0;radius<3;radius++)
+        for(int angle=0;angle<PATH_ANGLES;angle++){
+            uint8_t *b=cpu.mem+BENCH_BULLET;
+            int x=(40+shootingPoints[radius][angle][0])&0xFF, y=(60+shootingPoints[radius][angle][1])&0xFF;
+            z80_set_pair(&cpu, RP_HL, BENCH_BULLET);
+            cpu.r[R_B]=40;
+            cpu.r[R_C]=60;
+            cpu.r[R_D]=radius;
+            cpu.r[R_E]=angle;
+            bench_run(p, r);
+            costs[radius][angle]=(BenchCall){bench_last, bench_last_reads};
+            if(b[0]!=x || b[1]!=y || b[2]!=angle || b[3]!=0){
+                fprintf(stderr, "bench: %s radius %d angle %d gives (%d, %d), expected (%d, %d)\n", p->name, radius, angle,
+                    b[0], b[1], x, y);
+                return false;
+            }
+        }
+    return true;
+}
+
+static void bench_print(const Z80Program *p, const BenchResult *r){
+    printf("%-16s %5d %6ld %8.1f %6ld %8.1f\n", p->name, z80_size(p), r->min, (double)r->total/r->runs, r->max,
+        (double)r->msx_total/r->runs);
+}
+
+// Bullets a frame can afford when each one costs msx T-states
+static void bench_print_ceiling(const char *what, double msx){
+    printf("%-46s 60 Hz: %5d   50 Hz: %5d\n", what, (int)(Z80_FRAME_60HZ/msx), (int)(Z80_FRAME_50HZ/msx));
+}
+
+// Builds the consumer routines and checks them on every input against their C reference, which also measures
+// them. False if one doesn't match, the routines are freed by bench_close() anyway
+bool bench_open(void){
+    bool ok=true;
+
+    memset(r_aims, 0, sizeof(r_aims));
+    memset(r_steps, 0, sizeof(r_steps));
+    memset(r_spawns, 0, sizeof(r_spawns));
+    memset(&r_velocity, 0, sizeof(r_velocity));
+    bench_load_tables();
+    for(int i=0;i<BENCH_AIM_ROUTINES;i++){
+        bench_aim_programs[i]=bench_aims[i].build();
+        ok=ok && z80_link(&cpu, bench_aim_programs[i]);
+    }
+    for(int i=0;i<BENCH_SPAWNERS;i++){
+        bench_spawn_programs[i]=bench_spawners[i]();
+        ok=ok && z80_link(&cpu, bench_spawn_programs[i]);
+    }
+    bench_velocity_program=bench_step_velocity_routine();
+    ok=ok && z80_link(&cpu, bench_velocity_program);
+    for(int i=0;i<BENCH_STEPPERS;i++){
+        bench_step_programs[i]=bench_steppers[i].build();
+        ok=ok && z80_link(&cpu, bench_step_programs[i]);
+    }
+    for(int i=0;i<BENCH_AIM_ROUTINES;i++)
+        ok=ok && bench_aim(bench_aim_programs[i], &r_aims[i], bench_aims[i].check);
+    for(int i=0;i<BENCH_SPAWNERS;i++)
+        ok=ok && bench_spawn(bench_spawn_programs[i], &r_spawns[i], bench_spawn_costs[i]);
+    ok=ok && bench_velocity(bench_velocity_program, &r_velocity);
+    for(int i=0;i<BENCH_STEPPERS;i++)
+        ok=ok && bench_step(bench_step_programs[i], &r_steps[i], bench_step_costs[i], bench_steppers[i].origin);
+    return ok;
+}
+
+void bench_close(void){
+    for(int i=0;i<BENCH_AIM_ROUTINES;i++)
+        z80_free(bench_aim_programs[i]);
+    for(int i=0;i<BENCH_STEPPERS;i++)
+        z80_free(bench_step_programs[i]);
+    for(int i=0;i<BENCH_SPAWNERS;i++)
+        z80_free(bench_spawn_programs[i]);
+    z80_free(bench_velocity_program);
+}
+
+// Routines by kind (BENCH_KIND_AIM, BENCH_KIND_STEP or BENCH_KIND_SPAWN), the steppers followed by the 8.8
+// velocity one
+int bench_count(int kind){
+    if(kind==BENCH_KIND_SPAWN)
+        return BENCH_SPAWNERS;
+    return kind==BENCH_KIND_AIM ? BENCH_AIM_ROUTINES : BENCH_STEPPERS+1;
+}
+
+const char *bench_name(int kind, int i){
+    if(kind==BENCH_KIND_AIM)
+        return bench_aim_programs[i]->name;
+    if(kind==BENCH_KIND_SPAWN)
+        return bench_spawn_programs[i]->name;
+    return i<BENCH_STEPPERS ? bench_step_programs[i]->name : bench_velocity_program->name;
+}
+
+// An aimed shot with aim routine i, run on the model
+BenchCall bench_aim_call(int i, int ex, int ey, int px, int py){
+    BenchResult r={0};
+
+    bench_aim_run(bench_aim_programs[i], &r, ex, ey, px, py);
+    return (BenchCall){bench_last, bench_last_reads};
+}
+
+// A step with stepper i, as measured by bench_open()
+BenchCall bench_step_call(int i, int angle, int step){
+    return bench_step_costs[i][angle][step];
+}
+
+// A spawn with spawn routine i, as measured by bench_open()
+BenchCall bench_spawn_call(int i, int radius, int angle){
+    return bench_spawn_costs[i][radius][angle];
+}
+
+// Runs the consumer routines and prints the report. Returns false if a routine doesn't match its C reference
+bool bench_report(){
+    Z80Program **aims=bench_aim_programs, **steps=bench_step_programs;
+    bool ok=bench_open();
+
+    if(ok){
+        printf("Z80 cost of the table consumers, in T-states. MSX adds one wait state per M1 cycle.\n");
+        printf("Frame budget: %d T-states at 60 Hz, %d at 50 Hz\n\n", Z80_FRAME_60HZ, Z80_FRAME_50HZ);
+        printf("%-16s %5s %6s %8s %6s %8s\n", "routine", "bytes", "min", "avg", "max", "MSX avg");
+        for(int i=0;i<BENCH_AIM_ROUTINES;i++)
+            bench_print(aims[i], &r_aims[i]);
+        for(int i=0;i<BENCH_SPAWNERS;i++)
+            bench_print(bench_spawn_programs[i], &r_spawns[i]);
+        for(int i=0;i<BENCH_STEPPERS;i++)
+            bench_print(steps[i], &r_steps[i]);
+        bench_print(bench_velocity_program, &r_velocity);
+        printf("\nCeiling, with the whole frame spent on it:\n");
+        for(int i=0;i<BENCH_STEPPERS;i++){
+            char what[64];
+            snprintf(what, sizeof(what), "bullets moved with %s", bench_steppers[i].table);
+            bench_print_ceiling(what, (double)r_steps[i].msx_total/r_steps[i].runs);
+        }
+        bench_print_ceiling("bullets moved with PathVelocity (8.8)", (double)r_velocity.msx_total/r_velocity.runs);
+        bench_print_ceiling("aimed shots (aim + spawn, worst case)", r_aims[0].msx_max+r_spawns[0].msx_max);
+        bench_print_ceiling("aimed shots (log aim + spawn, worst case)", r_aims[1].msx_max+r_spawns[0].msx_max);
+        bench_print_ceiling("aimed rows (aim + quadrant + row, worst case)", r_aims[2].msx_max);
+        bench_print_ceiling("aimed rows (AimRowLUT, --aim-row, worst case)", r_aims[3].msx_max);
+        printf("\nAimRowLUT (%d bytes) saves %.1f T-states (MSX) per aimed shot on average, %ld in the worst case\n", 4*256*2,
+            (double)(r_aims[2].msx_total-r_aims[3].msx_total)/r_aims[3].runs, r_aims[2].msx_max-r_aims[3].msx_max);
+        printf("\nRoutines measured:\n\n");
+        for(int i=0;i<BENCH_AIM_ROUTINES;i++)
+            z80_print(stdout, aims[i], Z80_SJASM);
+        for(int i=0;i<BENCH_SPAWNERS;i++)
+            z80_print(stdout, bench_spawn_programs[i], Z80_SJASM);
+        for(int i=0;i<BENCH_STEPPERS;i++)
+            z80_print(stdout, steps[i], Z80_SJASM);
+        z80_print(stdout, bench_velocity_program, Z80_SJASM);
+    }
+    bench_close();
+    return ok;
+}
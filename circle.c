@@ -0,0 +1,169 @@
+#include <math.h>
+#include <stdlib.h>
+#include "generator.h"
+
+/*
+
+Circle paths, the path_circle code that used to be commented out in main(). Seven radii (16 to 112), moving
+DISTANCE pixels per step, the step count rounded up to a multiple of 4 so every quadrant has the same n steps.
+
+A full circle of radius 112 is 352 steps, 704 bytes, and the seven radii take 2.8 KB. Only the first octant is
+stored. The points of a quadrant are symmetric around 45 degrees (point k is point n-k with x and y swapped), so
+the deltas of the second octant are the first ones read backwards, swapped and negated:
+
+    d[k] = -swap(d[n+1-k])      for k > (n+1)/2
+
+and the other quadrants are rotations, the same ones as the folded PathAngleLUT. The circle starts at (radius, 0)
+of its center and turns the way the angles do, clockwise on the screen. CircleStep() walks the eight octants with
+two counters, no division.
+
+*/
+
+#define CIRCLE_RADII    7
+#define CIRCLE_MAX      360     // more than the steps of the largest circle
+
+static int circle_steps[CIRCLE_RADII];
+static int circle_octant[CIRCLE_RADII][CIRCLE_MAX/8+1][2];
+
+static int circle_radius(int r){
+    return (r+1)*16;
+}
+
+// Steps in the first octant of a quadrant of n steps, the middle one included when n is odd
+static int circle_octant_steps(int steps){
+    return (steps/4+1)/2;
+}
+
+// Full circle deltas, computed directly
+static void circle_full(int r, int (*deltas)[2]){
+    int steps=circle_steps[r], radius=circle_radius(r), px=radius, py=0;
+
+    for(int i=0;i<steps;i++){
+        double angle=(2*M_PI*(i+1))/(double)steps;
+        int cx=lround(cos(angle)*radius), cy=lround(sin(angle)*radius);
+        deltas[i][0]=cx-px;
+        deltas[i][1]=cy-py;
+        px=cx;
+        py=cy;
+    }
+}
+
+// Delta of a step rebuilt from the octant, the way CircleStep() does it
+static void circle_delta(int r, int step, int *dx, int *dy){
+    int n=circle_steps[r]/4, k=step%n, h=circle_octant_steps(circle_steps[r]);
+    int x, y;
+
+    if(k<h){
+        x=circle_octant[r][k][0];
+        y=circle_octant[r][k][1];
+    }
+    else{
+        x=-circle_octant[r][n-1-k][1];
+        y=-circle_octant[r][n-1-k][0];
+    }
+    fold_rotate(step/n*ANGLES_PER_QUADRANT, x, y, dx, dy);
+}
+
+// Computes the octants and checks the rebuilt circles against the direct ones, on stderr
+bool circle_build(void){
+    int full[CIRCLE_MAX][2], stored=0, total=0;
+
+    for(int r=0;r<CIRCLE_RADII;r++){
+        // the perimeter, DISTANCE pixels per step, rounded up to a multiple of 4
+        int steps=lround(2*M_PI*circle_radius(r)/DISTANCE), x=0, y=0, differ=0;
+        double error=0;
+        if(steps%4)
+            steps=steps+(4-steps%4);
+        circle_steps[r]=steps;
+        circle_full(r, full);
+        for(int i=0;i<circle_octant_steps(steps);i++){
+            circle_octant[r][i][0]=full[i][0];
+            circle_octant[r][i][1]=full[i][1];
+        }
+        for(int i=0;i<steps;i++){
+            int dx, dy;
+            double angle=(2*M_PI*(i+1))/(double)steps;
+            circle_delta(r, i, &dx, &dy);
+            if(dx!=full[i][0] || dy!=full[i][1])
+                differ++;
+            x+=dx;
+            y+=dy;
+            error=fmax(error, hypot(circle_radius(r)+x-cos(angle)*circle_radius(r), y-sin(angle)*circle_radius(r)));
+        }
+        if(x || y || error>=1){
+            fprintf(stderr, "circle: radius %d doesn't close, ends at (%d, %d), %.2f pixels off the circle\n", circle_radius(r), x, y, error);
+            return false;
+        }
+        fprintf(stderr, "circle: radius %3d, %3d steps, %2d stored, %d steps differ from the direct circle, %.2f pixels max error\n",
+            circle_radius(r), steps, circle_octant_steps(steps), differ, error);
+        stored+=circle_octant_steps(steps)*2;
+        total+=steps*2;
+    }
+    fprintf(stderr, "circle: %d bytes of deltas instead of %d\n", stored, total);
+    return true;
+}
+
+void circle_print(void){
+    char name[32], dims[32];
+
+    printf("enum   CIRCLE_RADII    {RADIUS16, RADIUS32, RADIUS48, RADIUS64, RADIUS80, RADIUS96, RADIUS112, MAX_CIRCLE_RADII};\n\n");
+    printf("// path is the first octant of the circle, octant steps long. steps is the full circle, a multiple of 4\n");
+    printf("typedef struct CirclePath{\n");
+    printf("    const i8  (*path)[2];\n");
+    printf("    u8  radius;\n");
+    printf("    u16 steps;\n");
+    printf("    u8  octant;\n");
+    printf("}CirclePath;\n\n");
+    for(int r=0;r<CIRCLE_RADII;r++){
+        int shape[2]={circle_octant_steps(circle_steps[r]), 2};
+        snprintf(name, sizeof(name), "CircleR%d", circle_radius(r));
+        snprintf(dims, sizeof(dims), "[%d][2]", shape[0]);
+        emit_table("i8", name, dims, &circle_octant[r][0][0], shape, 2);
+    }
+    printf("const CirclePath     CirclePathLUT[MAX_CIRCLE_RADII]={\n");
+    for(int r=0;r<CIRCLE_RADII;r++)
+        printf("    { CircleR%d, %d, %d, %d}%s\n", circle_radius(r), circle_radius(r), circle_steps[r],
+            circle_octant_steps(circle_steps[r]), r!=CIRCLE_RADII-1 ? "," : "");
+    printf("};\n\n");
+
+    printf("// Walks a circle one step per call, forever. Start with CircleStart(), the object at (radius, 0) of the center\n");
+    printf("typedef struct CircleWalker{\n");
+    printf("    const CirclePath    *circle;\n");
+    printf("    u8  octant;         // 0 to 7, odd octants read the path backwards\n");
+    printf("    u8  index;\n");
+    printf("}CircleWalker;\n\n");
+    printf("static void CircleStart(CircleWalker *w, u8 radius){\n");
+    printf("    w->circle = &CirclePathLUT[radius];\n");
+    printf("    w->octant = 0;\n");
+    printf("    w->index = 0;\n");
+    printf("}\n\n");
+    printf("static void CircleStep(CircleWalker *w, i8 *dx, i8 *dy){\n");
+    printf("    const CirclePath *c = w->circle;\n");
+    printf("    const i8 *d = c->path[w->index];\n");
+    printf("    u8 quadrant = w->octant >> 1;\n");
+    printf("    i8 x, y;\n");
+    printf("    if(w->octant & 1){\n");
+    printf("        x = -d[1]; y = -d[0];\n");
+    printf("        if(w->index == 0)\n");
+    printf("            w->octant = (w->octant + 1) & 7;\n");
+    printf("        else\n");
+    printf("            w->index--;\n");
+    printf("    }else{\n");
+    printf("        x = d[0]; y = d[1];\n");
+    printf("        if(++w->index == c->octant){\n");
+    printf("            w->octant++;\n");
+    printf("            w->index = (c->steps >> 2) - c->octant - 1;\n");
+    printf("        }\n");
+    printf("    }\n");
+    printf("    switch(quadrant){\n");
+    printf("        case 0: *dx =  x; *dy =  y; break;\n");
+    printf("        case 1: *dx = -y; *dy =  x; break;\n");
+    printf("        case 2: *dx = -x; *dy = -y; break;\n");
+    printf("        default:*dx =  y; *dy = -x; break;\n");
+    printf("    }\n");
+    printf("}\n\n");
+}
+
+void circle_print_externs(void){
+    printf("extern const CirclePath CirclePathLUT[MAX_CIRCLE_RADII];\n");
+}
@@ -0,0 +1,71 @@
+#include <math.h>
+#include <string.h>
+#include "generator.h"
+
+/*
+
+Easing curves: f(0)=0 and f(1)=1, t going from 0 to 1 along the path. "in" starts slow, "out" ends slow.
+"out-bounce" falls to the end and bounces three times on it, "in-bounce" does it backwards.
+
+*/
+
+static const char *ease_names[EASE_CURVES]={
+    "linear", "in-quad", "out-quad", "in-out-quad", "in-cubic", "out-cubic", "in-out-cubic", "in-sine", "out-sine", "in-out-sine",
+    "in-bounce", "out-bounce", "in-out-bounce"
+};
+
+// Curve with that name, or -1
+int ease_find(const char *name){
+    for(int i=0;i<EASE_CURVES;i++)
+        if(!strcmp(ease_names[i], name))
+            return i;
+    return -1;
+}
+
+const char *ease_name(int curve){
+    return ease_names[curve];
+}
+
+// Falls in t^2 to 1 at t=1/2.75, then bounces 3/4, 15/16 and 63/64 of the way back
+static double ease_bounce(double t){
+    const double k=7.5625, d=2.75;
+
+    if(t<1/d)
+        return k*t*t;
+    if(t<2/d)
+        return k*(t-1.5/d)*(t-1.5/d)+0.75;
+    if(t<2.5/d)
+        return k*(t-2.25/d)*(t-2.25/d)+0.9375;
+    return k*(t-2.625/d)*(t-2.625/d)+0.984375;
+}
+
+double ease_value(int curve, double t){
+    switch(curve){
+        case EASE_IN_QUAD:
+            return t*t;
+        case EASE_OUT_QUAD:
+            return 1-(1-t)*(1-t);
+        case EASE_IN_OUT_QUAD:
+            return t<0.5 ? 2*t*t : 1-2*(1-t)*(1-t);
+        case EASE_IN_CUBIC:
+            return t*t*t;
+        case EASE_OUT_CUBIC:
+            return 1-(1-t)*(1-t)*(1-t);
+        case EASE_IN_OUT_CUBIC:
+            return t<0.5 ? 4*t*t*t : 1-4*(1-t)*(1-t)*(1-t);
+        case EASE_IN_SINE:
+            return 1-cos(t*M_PI/2);
+        case EASE_OUT_SINE:
+            return sin(t*M_PI/2);
+        case EASE_IN_OUT_SINE:
+            return (1-cos(t*M_PI))/2;
+        case EASE_IN_BOUNCE:
+            return 1-ease_bounce(1-t);
+        case EASE_OUT_BOUNCE:
+            return ease_bounce(t);
+        case EASE_IN_OUT_BOUNCE:
+            return t<0.5 ? (1-ease_bounce(1-2*t))/2 : (1+ease_bounce(2*t-1))/2;
+        default:
+            return t;
+    }
+}
@@ -0,0 +1,540 @@
+#include <dirent.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include "generator.h"
+
+/*
+
+Output backends. With the C backend (the default) every table is printed as a const initializer in the header.
+With --backend=asm or --backend=bin the tables are kept in a registry instead, the header gets an extern in
+their place (so the routines and structs that use them still compile), and emit_finish() writes them out:
+
+    asm     DIR/shmup_lut.asm, sjasm/z80asm source with a db/dw block per table, labels with SDCC's leading _
+    bin     DIR/Name.bin per table, 16 bit values little endian, ready for incbin
+    split   DIR/Name.c per table, its own translation unit, and DIR/lut.mk listing them for make
+
+split only rewrites the files that change. The first line of a table file has a hash of its type, name, dims and
+values; a file with the same hash is left alone, so its mtime doesn't move and make doesn't rebuild it. A change
+to one table only rebuilds its own unit, the header and the units using it don't change. The table files use
+the plain C types (signed char for i8 and so on), they don't include the header. The table files of an earlier run
+that this one no longer has are deleted, the ones that start with the line paths writes only.
+
+--megarom=ascii8|konami (8 KB pages) or ascii16 (16 KB pages) packs the tables in ROM pages from --first-bank.
+The hot tables, the ones the bullet loop reads every frame, are placed first and all in the same page, so the loop
+never switches banks; the others are packed first fit, largest first. The header gets a NAME_BANK #define per
+table, the asm backend puts each page in its own block padded to the page size, the bin backend also writes
+DIR/bankN.bin, and DIR/shmup_lut.map lists page, offset and size of every symbol.
+
+--compress=Name,Name,... packs those tables with ZX0 (zx0.c), with any backend. The stream goes out as the u8
+table Name_zx0, and the header defines the table itself in RAM, no longer const, for the game to unpack it there
+at stage load with dzx0_standard (written to DIR/dzx0_standard.asm).
+
+*/
+
+#define EMIT_RANK   4
+
+typedef struct EmitTable{
+    char    type[8], name[64], dims[96];
+    int     *values;
+    int     count, elem;    // values, bytes per value
+    int     shape[EMIT_RANK], rank;
+    bool    hot;
+    int     bank, offset;
+}EmitTable;
+
+static EmitTable *tables;
+static int ntables, max_tables;
+static char **packed;           // the --compress tables found so far
+static int npacked;
+static bool packing, failed;
+
+static const char *mapper_names[]={"none", "ascii8", "ascii16", "konami"};
+
+// Tables read for every bullet or shot, kept together in one page
+static const char *hot_tables[]={"aim_matrix", "AimLog", "PathAngle", "PathVelocity", "PathRowPool", "Shooting", "Circle"};
+
+static bool emit_is_hot(const char *name){
+    for(int i=0;i<(int)(sizeof(hot_tables)/sizeof(hot_tables[0]));i++)
+        if(!strncmp(name, hot_tables[i], strlen(hot_tables[i])))
+            return true;
+    return false;
+}
+
+// True if --compress names the table
+static bool emit_is_compressed(const char *name){
+    const char *list=options.compress;
+
+    while(list && *list){
+        size_t length=strcspn(list, ",");
+        if(length==strlen(name) && !strncmp(list, name, length))
+            return true;
+        list+=length+(list[length]==',');
+    }
+    return false;
+}
+
+// True if the table must go through emit_table(), for the legacy printers of paths.c
+bool emit_routed(const char *name){
+    return options.backend!=BACKEND_C || emit_is_compressed(name);
+}
+
+// Qualifier of the table in the externs, the packed ones are unpacked to RAM
+const char *emit_const(const char *name){
+    return emit_is_compressed(name) ? "" : "const ";
+}
+
+// Packs the table with ZX0, prints the stream as NAME_zx0 and the table in RAM
+static void emit_compressed(const char *type, const char *name, const char *dims, const int *values, int count){
+    int elem=strstr(type, "16") ? 2 : 1, size=count*elem, shape[1], *bytes;
+    uint8_t *raw=malloc(size), *out=malloc(size+size/8+16);
+    char stream[80], length[16];
+
+    for(int i=0;i<count;i++){
+        raw[i*elem]=values[i]&0xFF;
+        if(elem==2)
+            raw[i*2+1]=(values[i]>>8)&0xFF;
+    }
+    if(!(shape[0]=zx0_pack(name, raw, size, out))){
+        failed=true;
+        free(raw);
+        free(out);
+        return;
+    }
+    if(!npacked)
+        printf("// ZX0 decompressor, dzx0_standard.asm in the --out directory. hl = src, de = dst with sdcccall(1)\n"
+            "void dzx0_standard(const void *src, void *dst);\n\n");
+    packed=realloc(packed, (npacked+1)*sizeof(char *));
+    packed[npacked++]=strdup(name);
+    bytes=malloc(shape[0]*sizeof(int));
+    for(int i=0;i<shape[0];i++)
+        bytes[i]=out[i];
+    snprintf(stream, sizeof(stream), "%s_zx0", name);
+    snprintf(length, sizeof(length), "[%d]", shape[0]);
+    printf("// %s packed from %d to %d bytes, unpack it at stage load: dzx0_standard(%s, %s)\n", name, size, shape[0], stream, name);
+    packing=true;
+    emit_table("u8", stream, length, bytes, shape, 1);
+    packing=false;
+    printf("%s %s%s;\n\n", type, name, dims);
+    free(bytes);
+    free(raw);
+    free(out);
+}
+
+static int emit_page_size(int mapper){
+    return mapper==MAPPER_ASCII16 ? 0x4000 : 0x2000;
+}
+
+// Prints one sub-array as nested braces, all in the same line: { { 2, 0}, { 2, 1}}
+static const int *emit_group(FILE *f, const int *values, const int *shape, int rank){
+    fprintf(f, "{ ");
+    for(int i=0;i<shape[0];i++){
+        if(rank==1)
+            fprintf(f, "%d", *values++);
+        else
+            values=emit_group(f, values, shape+1, rank-1);
+        if(i!=shape[0]-1)
+            fprintf(f, ", ");
+    }
+    fprintf(f, "}");
+    return values;
+}
+
+// The values of an initializer, 16 per line for a flat table, a line per row otherwise
+static void emit_values(FILE *f, const int *values, const int *shape, int rank, int count){
+    if(rank==1){
+        for(int i=0;i<count;i++){
+            if(i%16==0)
+                fprintf(f, "    ");
+            fprintf(f, "%3d", values[i]);
+            if(i!=count-1)
+                fprintf(f, ", ");
+            if(i%16==15 || i==count-1)
+                fprintf(f, "\n");
+        }
+    }
+    else{
+        for(int i=0;i<count;i++){
+            fprintf(f, "    ");
+            values=emit_group(f, values, shape+1, rank-1);
+            if(i!=count-1)
+                fprintf(f, ",");
+            fprintf(f, "\n");
+        }
+    }
+}
+
+// Prints a const C array. The values are given flat, in C order, and the shape is used to put the braces back.
+// dims is the text between the name and the initializer, so it may use the #defines of the header
+void emit_table(const char *type, const char *name, const char *dims, const int *values, const int *shape, int rank){
+    int count=shape[0];
+
+    if(emit_is_compressed(name)){
+        for(int i=1;i<rank;i++)
+            count*=shape[i];
+        emit_compressed(type, name, dims, values, count);
+        return;
+    }
+    if(options.backend!=BACKEND_C){
+        EmitTable *t;
+        if(ntables==max_tables){
+            max_tables=max_tables ? max_tables*2 : 64;
+            tables=realloc(tables, max_tables*sizeof(EmitTable));
+        }
+        t=&tables[ntables++];
+        for(int i=1;i<rank;i++)
+            count*=shape[i];
+        snprintf(t->type, sizeof(t->type), "%s", type);
+        snprintf(t->name, sizeof(t->name), "%s", name);
+        snprintf(t->dims, sizeof(t->dims), "%s", dims);
+        t->count=count;
+        t->elem=strstr(type, "16") ? 2 : 1;
+        t->values=malloc(count*sizeof(int));
+        memcpy(t->values, values, count*sizeof(int));
+        t->rank=rank<EMIT_RANK ? rank : EMIT_RANK;
+        memcpy(t->shape, shape, t->rank*sizeof(int));
+        t->hot=emit_is_hot(name) && !packing;     // a packed stream is only read at stage load
+        printf("extern const %s %s%s;\n\n", type, name, dims);
+        return;
+    }
+
+    printf("const %s %s%s={\n", type, name, dims);
+    emit_values(stdout, values, shape, rank, count);
+    printf("};\n\n");
+}
+
+static int emit_size(const EmitTable *t){
+    return t->count*t->elem;
+}
+
+static int emit_compare_size(const void *a, const void *b){
+    const EmitTable *ta=*(const EmitTable **)a, *tb=*(const EmitTable **)b;
+
+    return emit_size(tb)-emit_size(ta);
+}
+
+// Gives a bank and an offset to every table. Returns how many banks are used, or 0 if a table can't be placed
+static int emit_pack(int page, int first){
+    EmitTable **order=malloc(ntables*sizeof(EmitTable *));
+    int *used=calloc(ntables+1, sizeof(int)), banks=1, hot=0;
+
+    for(int i=0;i<ntables;i++)
+        if(tables[i].hot){
+            tables[i].bank=first;
+            tables[i].offset=used[0];
+            used[0]+=emit_size(&tables[i]);
+            hot++;
+        }
+    if(used[0]>page){
+        fprintf(stderr, "emit: the hot tables take %d bytes, more than a %d bytes page\n", used[0], page);
+        banks=0;
+    }
+    for(int i=0;i<ntables;i++)
+        order[i]=&tables[i];
+    qsort(order, ntables, sizeof(EmitTable *), emit_compare_size);
+    for(int i=0;i<ntables && banks;i++){
+        EmitTable *t=order[i];
+        int b;
+        if(t->hot)
+            continue;
+        if(emit_size(t)>page){
+            fprintf(stderr, "emit: %s takes %d bytes, more than a %d bytes page\n", t->name, emit_size(t), page);
+            banks=0;
+            break;
+        }
+        for(b=0;used[b]+emit_size(t)>page;b++);
+        if(b==banks)
+            banks++;
+        t->bank=first+b;
+        t->offset=used[b];
+        used[b]+=emit_size(t);
+    }
+    if(banks)
+        fprintf(stderr, "emit: %d tables in %d pages of %d KB from page %d, the %d hot ones in page %d\n", ntables, banks,
+            page/1024, first, hot, first);
+    free(order);
+    free(used);
+    return banks;
+}
+
+static int emit_compare_place(const void *a, const void *b){
+    const EmitTable *ta=*(const EmitTable **)a, *tb=*(const EmitTable **)b;
+
+    return ta->bank!=tb->bank ? ta->bank-tb->bank : ta->offset-tb->offset;
+}
+
+static void emit_bytes(const EmitTable *t, uint8_t *out){
+    for(int i=0;i<t->count;i++){
+        out[i*t->elem]=t->values[i]&0xFF;
+        if(t->elem==2)
+            out[i*2+1]=(t->values[i]>>8)&0xFF;
+    }
+}
+
+// Writes DIR/FILEEXT into path. Returns false, with a message, if it doesn't fit
+static bool emit_path(char *path, size_t size, const char *dir, const char *file, const char *ext){
+    if(snprintf(path, size, "%s/%s%s", dir, file, ext)<(int)size)
+        return true;
+    fprintf(stderr, "emit: path %s/%s%s is longer than %d characters\n", dir, file, ext, (int)size-1);
+    return false;
+}
+
+static FILE *emit_open(const char *dir, const char *file){
+    char path[1024];
+    FILE *f;
+
+    if(!emit_path(path, sizeof(path), dir, file, ""))
+        return NULL;
+    if(!(f=fopen(path, "wb")))
+        fprintf(stderr, "emit: can't write %s\n", path);
+    return f;
+}
+
+static void emit_asm_table(FILE *f, const EmitTable *t){
+    fprintf(f, "_%s:\n", t->name);
+    for(int i=0;i<t->count;i++){
+        if(i%16==0)
+            fprintf(f, "        %s ", t->elem==2 ? "dw" : "db");
+        fprintf(f, "%d", t->values[i]);
+        fprintf(f, i%16==15 || i==t->count-1 ? "\n" : ",");
+    }
+}
+
+// FNV-1a of the names of the tables, for lut.mk
+static uint64_t emit_list_hash(void){
+    uint64_t h=0xCBF29CE484222325ULL;
+
+    for(int i=0;i<ntables;i++)
+        for(const char *c=tables[i].name;;c++){
+            h=(h^(uint8_t)*c)*0x100000001B3ULL;
+            if(!*c)
+                break;
+        }
+    return h;
+}
+
+// FNV-1a of what a table file is made of
+static uint64_t emit_hash(const EmitTable *t){
+    uint64_t h=0xCBF29CE484222325ULL;
+    char text[256];
+    int length=snprintf(text, sizeof(text), "%s %s%s", t->type, t->name, t->dims);
+
+    for(int i=0;i<length;i++)
+        h=(h^(uint8_t)text[i])*0x100000001B3ULL;
+    for(int i=0;i<t->count;i++)
+        for(int b=0;b<4;b++)
+            h=(h^(uint8_t)(t->values[i]>>(b*8)))*0x100000001B3ULL;
+    return h;
+}
+
+// True if the file at path starts with line
+static bool emit_same(const char *path, const char *line){
+    char first[256]="";
+    FILE *f=fopen(path, "r");
+
+    if(!f)
+        return false;
+    if(!fgets(first, sizeof(first), f))
+        first[0]=0;
+    fclose(f);
+    return !strcmp(first, line);
+}
+
+static const char *emit_c_type(const char *type){
+    if(!strcmp(type, "i8"))
+        return "signed char";
+    if(!strcmp(type, "i16"))
+        return "short";
+    if(!strcmp(type, "u16"))
+        return "unsigned short";
+    return "unsigned char";
+}
+
+// Deletes the DIR/Name.c files written by an earlier run for tables that are gone. Returns how many
+static int emit_split_clean(const char *dir){
+    DIR *d=opendir(dir);
+    struct dirent *e;
+    int removed=0;
+
+    if(!d)
+        return 0;
+    while((e=readdir(d))){
+        size_t length=strlen(e->d_name);
+        char name[256], path[1024], line[sizeof(name)+32], first[sizeof(line)]="";
+        bool found=false;
+        FILE *f;
+        if(length<3 || strcmp(e->d_name+length-2, ".c"))
+            continue;
+        snprintf(name, sizeof(name), "%.*s", (int)(length-2), e->d_name);
+        for(int i=0;i<ntables && !found;i++)
+            found=!strcmp(tables[i].name, name);
+        if(found)
+            continue;
+        if(!emit_path(path, sizeof(path), dir, e->d_name, "") || !(f=fopen(path, "r")))
+            continue;
+        if(!fgets(first, sizeof(first), f))
+            first[0]=0;
+        fclose(f);
+        // only the files paths wrote
+        snprintf(line, sizeof(line), "// %s, written by paths, hash ", name);
+        if(!strncmp(first, line, strlen(line)) && !remove(path))
+            removed++;
+    }
+    closedir(d);
+    return removed;
+}
+
+// Writes DIR/Name.c of every table that changed and DIR/lut.mk. Returns false if a file can't be written
+static bool emit_split(const char *dir){
+    int written=0, removed=emit_split_clean(dir);
+    FILE *f;
+    char path[1024], line[256];
+
+    for(int i=0;i<ntables;i++){
+        const EmitTable *t=&tables[i];
+        if(!emit_path(path, sizeof(path), dir, t->name, ".c"))
+            return false;
+        snprintf(line, sizeof(line), "// %s, written by paths, hash %016" PRIx64 "\n", t->name, emit_hash(t));
+        if(emit_same(path, line))
+            continue;
+        if(!(f=fopen(path, "w"))){
+            fprintf(stderr, "emit: can't write %s\n", path);
+            return false;
+        }
+        fprintf(f, "%s", line);
+        fprintf(f, "// %s%s in the header, rewritten by paths only when it changes\n\n", t->type, t->dims);
+        fprintf(f, "const %s %s", emit_c_type(t->type), t->name);
+        for(int r=0;r<t->rank;r++)
+            fprintf(f, "[%d]", t->shape[r]);
+        fprintf(f, "={\n");
+        emit_values(f, t->values, t->shape, t->rank, t->shape[0]);
+        fprintf(f, "};\n");
+        fclose(f);
+        written++;
+    }
+    // the list of tables, rewritten only if a table comes or goes
+    if(!emit_path(path, sizeof(path), dir, "lut.mk", ""))
+        return false;
+    snprintf(line, sizeof(line), "# Tables written by paths --backend=split, %d tables, hash %016" PRIx64 "\n", ntables,
+        emit_list_hash());
+    if(!emit_same(path, line)){
+        if(!(f=fopen(path, "w"))){
+            fprintf(stderr, "emit: can't write %s\n", path);
+            return false;
+        }
+        fprintf(f, "%s", line);
+        fprintf(f, "LUT_TABLES =");
+        for(int i=0;i<ntables;i++)
+            fprintf(f, " %s", tables[i].name);
+        fprintf(f, "\n");
+        fclose(f);
+    }
+    fprintf(stderr, "emit: %d tables in %s, %d rewritten, %d unchanged, %d deleted\n", ntables, dir, written, ntables-written,
+        removed);
+    return true;
+}
+
+// Writes the registered tables with the asm or bin backend, and prints the bank #defines. Returns false on errors
+bool emit_finish(void){
+    int page=emit_page_size(options.mapper), banks=0;
+    EmitTable **order=malloc((ntables+1)*sizeof(EmitTable *));
+    uint8_t *data;
+    FILE *f;
+
+    if(failed)
+        return false;
+    for(const char *list=options.compress;list && *list;){
+        size_t length=strcspn(list, ",");
+        bool found=false;
+        for(int i=0;i<npacked && !found;i++)
+            found=strlen(packed[i])==length && !strncmp(packed[i], list, length);
+        if(!found){
+            fprintf(stderr, "emit: --compress names %.*s, there's no such table in this header\n", (int)length, list);
+            return false;
+        }
+        list+=length+(list[length]==',');
+    }
+    if(!zx0_finish(options.out))
+        return false;
+    if(options.backend==BACKEND_C)
+        return true;
+    if(options.backend==BACKEND_SPLIT){
+        free(order);
+        return emit_split(options.out);
+    }
+    if(options.mapper!=MAPPER_NONE){
+        if(!(banks=emit_pack(page, options.first_bank)))
+            return false;
+        printf("// ROM pages of the tables, --megarom=%s\n", mapper_names[options.mapper]);
+        for(int i=0;i<ntables;i++)
+            printf("#define %s_BANK %d\n", tables[i].name, tables[i].bank);
+        printf("\n");
+        for(int i=0;i<ntables;i++)
+            order[i]=&tables[i];
+        qsort(order, ntables, sizeof(EmitTable *), emit_compare_place);
+        if(!(f=emit_open(options.out, "shmup_lut.map")))
+            return false;
+        fprintf(f, "; %-6s %-6s %-6s %s\n", "page", "offset", "size", "symbol");
+        for(int i=0;i<ntables;i++)
+            fprintf(f, "  %-6d 0x%04X %-6d _%s%s\n", order[i]->bank, order[i]->offset, emit_size(order[i]), order[i]->name,
+                order[i]->hot ? " (hot)" : "");
+        fclose(f);
+    }
+    if(options.backend==BACKEND_ASM){
+        if(!(f=emit_open(options.out, "shmup_lut.asm")))
+            return false;
+        fprintf(f, "; Tables generated by paths, declared in the C header as extern\n\n");
+        if(options.mapper==MAPPER_NONE)
+            for(int i=0;i<ntables;i++)
+                emit_asm_table(f, &tables[i]);
+        for(int i=0;i<ntables && banks;i++){
+            // a page starts, the tables are in offset order so every label lands where the map says
+            if(!i || order[i]->bank!=order[i-1]->bank)
+                fprintf(f, "; page %d, %s\n", order[i]->bank, mapper_names[options.mapper]);
+            emit_asm_table(f, order[i]);
+            if(i==ntables-1 || order[i+1]->bank!=order[i]->bank){
+                int used=order[i]->offset+emit_size(order[i]);
+                if(used<page)
+                    fprintf(f, "        ds %d,255\n", page-used);
+                fprintf(f, "\n");
+            }
+        }
+        fclose(f);
+    }
+    else{
+        int size=page;
+        // big enough for a page and for the largest table
+        for(int i=0;i<ntables;i++)
+            size=emit_size(&tables[i])>size ? emit_size(&tables[i]) : size;
+        data=malloc(size);
+        for(int i=0;i<ntables;i++){
+            char file[80];
+            snprintf(file, sizeof(file), "%s.bin", tables[i].name);
+            if(!(f=emit_open(options.out, file))){
+                free(data);
+                return false;
+            }
+            emit_bytes(&tables[i], data);
+            fwrite(data, 1, emit_size(&tables[i]), f);
+            fclose(f);
+        }
+        for(int b=0;b<banks;b++){
+            char file[32];
+            memset(data, 0xFF, page);
+            for(int i=0;i<ntables;i++)
+                if(tables[i].bank==options.first_bank+b)
+                    emit_bytes(&tables[i], data+tables[i].offset);
+            snprintf(file, sizeof(file), "bank%d.bin", options.first_bank+b);
+            if(!(f=emit_open(options.out, file))){
+                free(data);
+                return false;
+            }
+            fwrite(data, 1, page, f);
+            fclose(f);
+        }
+        free(data);
+    }
+    fprintf(stderr, "emit: %d tables written to %s\n", ntables, options.out);
+    free(order);
+    return true;
+}
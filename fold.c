@@ -0,0 +1,102 @@
+#include "generator.h"
+
+/*
+
+PathAngleLUT only needs one quadrant, or even one octant. For an angle a in the first quadrant (0 to 31):
+
+    angle 32-a    is a mirrored on the 45 degrees diagonal:  (dx, dy) -> ( dy,  dx)
+    angle a+32    is a rotated 90 degrees:                   (dx, dy) -> (-dy,  dx)
+    angle a+64    is a rotated 180 degrees:                  (dx, dy) -> (-dx, -dy)
+    angle a+96    is a rotated 270 degrees:                  (dx, dy) -> ( dy, -dx)
+
+lround() rounds halves away from zero, so the rounding is symmetric and the rebuilt table should be identical
+to the full one. It is still checked byte by byte before anything is printed.
+
+*/
+
+int fold_rows(int mode){
+    return mode==FOLD_OCTANT ? FOLD_OCTANT_ROWS : FOLD_QUADRANT_ROWS;
+}
+
+// Host side copy of the routine printed by fold_print(), used to check the folded table
+void fold_delta(const int (*folded)[PATH_STEPS][2], int mode, int angle, int step, int *dx, int *dy){
+    int a=angle&(ANGLES_PER_QUADRANT-1), x, y;
+
+    if(mode==FOLD_OCTANT && a>ANGLES_PER_QUADRANT/2){
+        x=folded[ANGLES_PER_QUADRANT-a][step][1];
+        y=folded[ANGLES_PER_QUADRANT-a][step][0];
+    }
+    else{
+        x=folded[a][step][0];
+        y=folded[a][step][1];
+    }
+    fold_rotate(angle, x, y, dx, dy);
+}
+
+void fold_rotate(int angle, int x, int y, int *dx, int *dy){
+    switch((angle/ANGLES_PER_QUADRANT)&3){
+        case 0: *dx= x; *dy= y; break;
+        case 1: *dx=-y; *dy= x; break;
+        case 2: *dx=-x; *dy=-y; break;
+        default:*dx= y; *dy=-x; break;
+    }
+}
+
+// Rebuilds the 128 angles from the folded rows and compares them with path_angle_lut. The folded rows are
+// the first rows of path_angle_lut, so the full table is also the folded source.
+bool fold_verify(int mode){
+    int dx, dy;
+
+    for(int i=0;i<PATH_ANGLES;i++)
+        for(int step=0;step<PATH_STEPS;step++){
+            fold_delta((const int (*)[PATH_STEPS][2])path_angle_lut, mode, i, step, &dx, &dy);
+            if(dx!=path_angle_lut[i][step][0] || dy!=path_angle_lut[i][step][1]){
+                fprintf(stderr, "fold: angle %d step %d rebuilt as (%d, %d), PathAngleLUT has (%d, %d)\n", i, step, dx, dy,
+                    path_angle_lut[i][step][0], path_angle_lut[i][step][1]);
+                return false;
+            }
+        }
+    fprintf(stderr, "fold: %s rebuilds PathAngleLUT byte for byte, %d bytes instead of %d\n", mode==FOLD_OCTANT ? "octant" : "quadrant",
+        fold_rows(mode)*PATH_STEPS*2, PATH_ANGLES*PATH_STEPS*2);
+    return true;
+}
+
+// Prints the folded rows and the SDCC routine that rebuilds any PathAngleLUT entry from them
+void fold_print(int mode){
+    int shape[3]={fold_rows(mode), PATH_STEPS, 2};
+
+    printf("// PathAngleLUT folded to the first %s, use PathAngleDelta() to read it\n", mode==FOLD_OCTANT ? "octant" : "quadrant");
+    printf("#define PATH_FOLD_ROWS %d\n", shape[0]);
+    emit_table("i8", "PathAngleFold", "[PATH_FOLD_ROWS][PATH_STEPS][2]", &path_angle_lut[0][0][0], shape, 3);
+
+    printf("// Same as dx=PathAngleLUT[angle][step][0], dy=PathAngleLUT[angle][step][1]\n");
+    printf("static void PathAngleDelta(u8 angle, u8 step, i8 *dx, i8 *dy){\n");
+    printf("    u8 a = angle & %d;\n", ANGLES_PER_QUADRANT-1);
+    printf("    i8 x, y;\n");
+    if(mode==FOLD_OCTANT){
+        printf("    if(a > %d){\n", ANGLES_PER_QUADRANT/2);
+        printf("        x = PathAngleFold[%d - a][step][1];\n", ANGLES_PER_QUADRANT);
+        printf("        y = PathAngleFold[%d - a][step][0];\n", ANGLES_PER_QUADRANT);
+        printf("    }\n");
+        printf("    else{\n");
+        printf("        x = PathAngleFold[a][step][0];\n");
+        printf("        y = PathAngleFold[a][step][1];\n");
+        printf("    }\n");
+    }
+    else{
+        printf("    x = PathAngleFold[a][step][0];\n");
+        printf("    y = PathAngleFold[a][step][1];\n");
+    }
+    fold_print_rotation();
+    printf("}\n\n");
+}
+
+// Prints the end of the rebuild routines: (x, y) holds the first quadrant delta and is rotated to the quadrant of angle
+void fold_print_rotation(){
+    printf("    switch(angle / %d){\n", ANGLES_PER_QUADRANT);
+    printf("        case 0:  *dx =  x; *dy =  y; break;\n");
+    printf("        case 1:  *dx = -y; *dy =  x; break;\n");
+    printf("        case 2:  *dx = -x; *dy = -y; break;\n");
+    printf("        default: *dx =  y; *dy = -x; break;\n");
+    printf("    }\n");
+}
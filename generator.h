@@ -0,0 +1,215 @@
+#ifndef GENERATOR_H
+#define GENERATOR_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#define DEBUG               false
+#define PATH_STEPS          16      // Enough to move through 32 pixels at 1 pixels speed
+#define PATH_ANGLES         128     // there should be 120 angles stored in the structure
+#define DISTANCE            2
+#define ANGLES_PER_QUADRANT 32
+
+// Rows kept when PathAngleLUT is folded: a full quadrant, or the first octant (0 to 45 degrees, both ends included)
+#define FOLD_QUADRANT_ROWS  ANGLES_PER_QUADRANT
+#define FOLD_OCTANT_ROWS    (ANGLES_PER_QUADRANT/2+1)
+
+#define MAX_SPEEDS          16
+
+enum FOLD_MODES {FOLD_NONE, FOLD_QUADRANT, FOLD_OCTANT};
+enum LAYOUTS {LAYOUT_NONE, LAYOUT_AOS, LAYOUT_SOA, LAYOUT_SOA_PAGE};
+enum BACKENDS {BACKEND_C, BACKEND_ASM, BACKEND_BIN, BACKEND_SPLIT};
+enum MAPPERS {MAPPER_NONE, MAPPER_ASCII8, MAPPER_ASCII16, MAPPER_KONAMI};
+enum EASE_CURVES {EASE_LINEAR, EASE_IN_QUAD, EASE_OUT_QUAD, EASE_IN_OUT_QUAD, EASE_IN_CUBIC, EASE_OUT_CUBIC, EASE_IN_OUT_CUBIC,
+    EASE_IN_SINE, EASE_OUT_SINE, EASE_IN_OUT_SINE, EASE_IN_BOUNCE, EASE_OUT_BOUNCE, EASE_IN_OUT_BOUNCE, EASE_CURVES};
+
+// One speed of --batch
+typedef struct BatchEntry{
+    double  speed;          // pixels per step
+    int     steps;
+}BatchEntry;
+
+// MSX T-states of a call on the Z80 model and the table bytes it reads
+typedef struct BenchCall{
+    long    msx;
+    int     reads;
+}BenchCall;
+
+// Command line options, filled by main() before any table is printed
+typedef struct Options{
+    int fold;               // FOLD_NONE, FOLD_QUADRANT or FOLD_OCTANT
+    bool pack;              // PathAngleLUT packed as one nibble per step
+    bool bench;             // print the Z80 cost report instead of the header
+    int layout;             // LAYOUT_NONE keeps the tables where SDCC puts them
+    int page_base;          // address of the first page aligned table
+    double speeds[MAX_SPEEDS];  // --velocity speeds, pixels per frame
+    int nspeeds;            // 0 when PathAngleLUT is printed
+    BatchEntry batch[MAX_SPEEDS];   // --batch speeds and step counts
+    int nbatch;
+    const char *spec;       // path spec file, NULL if none
+    bool circles;           // print the octant circle paths
+    bool aim_report;        // print the aim table analysis instead of the header
+    int aim_size;           // --aim table size, 0 prints aim_matrix as always
+    int aim_shift;          // bits shifted per normalization iteration of --aim
+    bool aim_log;           // also print the constant time log aim tables
+    int backend;            // BACKEND_C prints the tables in the header
+    const char *out;        // directory of the asm/bin files
+    int mapper;             // MAPPER_NONE leaves the ROM pages to the linker
+    int first_bank;         // first ROM page used by --megarom
+    const char *compress;   // --compress table names, comma separated, NULL if none
+    int offsets;            // --offsets frames, 0 prints no cumulative table
+    const char *patterns;   // --patterns list, "" for the default set, NULL if none
+    const char *steer;      // --steer rows, "" for the default set, NULL if none
+    int lifetime;           // --lifetime spawn cell in pixels, 0 prints no exit tables
+    bool aim_row;           // also print AimRowLUT, aim_matrix cells straight to PathAngleLUT/PathVelocity rows
+    int steppers;           // --steppers unroll factor, 0 writes no batch stepper
+    const char *shooting;   // --shooting radii, "" for the ShootingCircle ones, NULL prints ShootingCircle
+    int hires;              // --hires angles, 256 or 512, 0 prints no dither masks
+    const char *replay;     // --replay trace, "" for the built-in script, NULL if none
+    int replay_share;       // percent of the frame the bullets may take in the --replay report
+    double round;           // --round bound in pixels, 0 keeps the lround PathAngleLUT rows
+    bool round_free;        // --round rows may end off the lround position
+    const char *sweep;      // --sweep ranges, "" for the default ones, NULL if none
+}Options;
+
+extern Options options;
+
+// Tables calculated by main()
+extern int path_angle_lut[PATH_ANGLES][PATH_STEPS][2];
+extern uint8_t angle_to_lut[360];
+extern uint8_t targeting16x16[256];
+extern int shootingPoints[3][PATH_ANGLES][2];
+extern uint8_t aim_log[256], aim_log_angle[256];
+
+// paths.c
+void linear_row(double angle, double speed, int steps, int (*row)[2]);
+void speed_name(double speed, char *name, int size);
+
+// emit.c
+void emit_table(const char *type, const char *name, const char *dims, const int *values, const int *shape, int rank);
+bool emit_routed(const char *name);
+const char *emit_const(const char *name);
+bool emit_finish(void);
+
+// fold.c
+int fold_rows(int mode);
+void fold_rotate(int angle, int x, int y, int *dx, int *dy);
+void fold_print_rotation(void);
+void fold_delta(const int (*folded)[PATH_STEPS][2], int mode, int angle, int step, int *dx, int *dy);
+bool fold_verify(int mode);
+void fold_print(int mode);
+
+// pack.c
+bool pack_verify(int fold);
+void pack_print(int fold);
+
+// layout.c
+void layout_report(int base);
+void layout_print(int layout, int base);
+int layout_address(int layout, int base, const char *name);
+
+// velocity.c
+int velocity_value(double speed, int angle, int axis);
+void velocity_report(const double *speeds, int count);
+void velocity_print(const double *speeds, int count);
+
+// batch.c
+bool batch_build(const BatchEntry *entries, int count, int fold);
+void batch_print(const BatchEntry *entries, int count);
+void batch_print_externs(const BatchEntry *entries, int count);
+
+// ease.c
+int ease_find(const char *name);
+const char *ease_name(int curve);
+double ease_value(int curve, double t);
+
+// spec.c
+bool spec_print_paths(const char *file);
+void spec_print_externs(void);
+
+// circle.c
+bool circle_build(void);
+void circle_print(void);
+void circle_print_externs(void);
+
+// offsets.c
+bool offsets_build(int frames, int fold);
+void offsets_print(int fold);
+void offsets_print_externs(int fold);
+
+// patterns.c
+bool patterns_build(const char *list);
+void patterns_print(void);
+void patterns_print_externs(void);
+
+// steer.c
+bool steer_build(const char *list);
+void steer_print(void);
+void steer_print_externs(void);
+
+// lifetime.c
+bool lifetime_build(int cell);
+void lifetime_print(void);
+void lifetime_print_externs(void);
+
+// shooting.c
+bool shooting_build(const char *list);
+int shooting_count(void);
+int shooting_point(int r, int angle, int axis);
+void shooting_print(void);
+void shooting_print_externs(void);
+
+// hires.c
+bool hires_build(int angles);
+void hires_print(bool delta);
+void hires_print_externs(void);
+
+// stepper.c
+bool stepper_build(int base, int unroll);
+void stepper_print(void);
+bool stepper_finish(const char *dir, int base);
+bool stepper_open(int base, int unroll);
+const char *stepper_name(int layout);
+BenchCall stepper_call(int layout, int count);
+
+// aim.c
+int aim_entry(int dx, int dy);
+int aim_bits(int size);
+void aim_build(int size, uint8_t *table);
+int aim_angle(const uint8_t *table, int size, int shift, int dx, int dy, int *iterations);
+void aim_log_build(void);
+int aim_log_angle_of(int dx, int dy);
+int aim_quadrant(int angle, int quadrant);
+void aim_report(void);
+void aim_print(int size, int shift);
+void aim_log_print(void);
+void aim_row_print(bool velocity);
+
+// zx0.c
+int zx0_compress(const uint8_t *in, int size, uint8_t *out);
+int zx0_pack(const char *name, const uint8_t *in, int size, uint8_t *out);
+bool zx0_finish(const char *dir);
+
+// round.c
+bool round_build(double bound, bool free);
+
+// replay.c
+bool replay_report(const char *file, int share);
+
+// sweep.c
+bool sweep_report(const char *ranges);
+
+// bench.c
+enum BENCH_KINDS {BENCH_KIND_AIM, BENCH_KIND_STEP, BENCH_KIND_SPAWN};
+
+bool bench_report(void);
+bool bench_open(void);
+void bench_close(void);
+int bench_count(int kind);
+const char *bench_name(int kind, int i);
+BenchCall bench_aim_call(int i, int ex, int ey, int px, int py);
+BenchCall bench_step_call(int i, int angle, int step);
+BenchCall bench_spawn_call(int i, int radius, int angle);
+
+#endif
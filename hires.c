@@ -0,0 +1,185 @@
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "generator.h"
+
+/*
+
+256 or 512 angles out of the 128 of PathAngleLUT. A fine angle is a row a = angle/S (S = 2 or 4) plus a fraction
+f = angle%S of the way to row a+1. A bullet between the two rows takes the step of row a on some frames and the
+one of row a+1 on the others, so on average it moves in between:
+
+    PathDither[f][frame/8] & 1<<(frame%8)   take row a+1 on this frame
+
+The pattern is 64 frames long, four rows, because a single row of 16 steps isn't enough to spread the fraction:
+the steps of two neighbouring rows are often the same. It is the same for every angle, picked greedily frame by
+frame for the least error over the 128 rows, then refined by flipping single bits while the error over 256
+frames goes down. That's 8 bytes per fraction, instead of 4 KB more of PathAngleLUT per 128 angles.
+
+The report compares the dithered bullets, a real PathAngleLUT of 256/512 angles and the nearest 128 angle row
+(what a spiral does today) with the true line.
+
+*/
+
+#define HIRES_FRAMES    64      // length of the dither pattern, a multiple of PATH_STEPS
+#define HIRES_DRIFT     256     // frames measured
+#define HIRES_MAX       4
+
+typedef struct HiresError{
+    double  max, total, end;
+    long    count;
+}HiresError;
+
+static int hires_angles, hires_sub;
+static uint64_t hires_mask[HIRES_MAX];
+
+static void hires_error_add(HiresError *e, double error, int frame){
+    if(error>e->max)
+        e->max=error;
+    if(frame==HIRES_DRIFT && error>e->end)
+        e->end=error;
+    e->total+=error;
+    e->count++;
+}
+
+// Row taken on frame (from 0) by a bullet at fine angle with dither mask
+static int hires_row(int angle, uint64_t mask, int frame){
+    int a=angle/hires_sub;
+
+    return mask>>(frame%HIRES_FRAMES)&1 ? (a+1)&(PATH_ANGLES-1) : a;
+}
+
+// Error of a bullet at fine angle walking the dithered rows, or row when it isn't NULL
+static void hires_walk(int angle, uint64_t mask, int (*row)[2], HiresError *e){
+    double radians=angle*2*M_PI/hires_angles;
+    int px=0, py=0;
+
+    for(int frame=1;frame<=HIRES_DRIFT;frame++){
+        int step=(frame-1)%PATH_STEPS;
+        if(row){
+            px+=row[step][0];
+            py+=row[step][1];
+        }
+        else{
+            int r=hires_row(angle, mask, frame-1);
+            px+=path_angle_lut[r][step][0];
+            py+=path_angle_lut[r][step][1];
+        }
+        hires_error_add(e, fmax(fabs(px-cos(radians)*DISTANCE*frame), fabs(py-sin(radians)*DISTANCE*frame)), frame);
+    }
+}
+
+// Mean error of every angle with fraction f
+static double hires_cost(int f, uint64_t mask){
+    HiresError e={0};
+
+    for(int a=0;a<PATH_ANGLES;a++)
+        hires_walk(a*hires_sub+f, mask, NULL, &e);
+    return e.total/e.count;
+}
+
+// Dither mask of fraction f: greedy over the frames, then single bit flips
+static uint64_t hires_dither(int f){
+    int px[PATH_ANGLES]={0}, py[PATH_ANGLES]={0};
+    uint64_t mask=0;
+    double cost;
+    bool better=true;
+
+    for(int frame=1;frame<=HIRES_FRAMES;frame++){
+        int step=(frame-1)%PATH_STEPS;
+        double error[2]={0, 0};
+        for(int a=0;a<PATH_ANGLES;a++){
+            double radians=(a*hires_sub+f)*2*M_PI/hires_angles, tx=cos(radians)*DISTANCE*frame, ty=sin(radians)*DISTANCE*frame;
+            for(int next=0;next<2;next++){
+                int r=(a+next)&(PATH_ANGLES-1);
+                error[next]+=fmax(fabs(px[a]+path_angle_lut[r][step][0]-tx), fabs(py[a]+path_angle_lut[r][step][1]-ty));
+            }
+        }
+        if(error[1]<error[0])
+            mask|=(uint64_t)1<<(frame-1);
+        for(int a=0;a<PATH_ANGLES;a++){
+            int r=hires_row(a*hires_sub+f, mask, frame-1);
+            px[a]+=path_angle_lut[r][step][0];
+            py[a]+=path_angle_lut[r][step][1];
+        }
+    }
+    cost=hires_cost(f, mask);
+    for(int pass=0;pass<4 && better;pass++){
+        better=false;
+        for(int bit=0;bit<HIRES_FRAMES;bit++){
+            uint64_t flipped=mask^(uint64_t)1<<bit;
+            double c=hires_cost(f, flipped);
+            if(c<cost){
+                mask=flipped;
+                cost=c;
+                better=true;
+            }
+        }
+    }
+    return mask;
+}
+
+static void hires_report_line(const char *name, HiresError *e){
+    fprintf(stderr, "hires: %-18s %8.2f %8.2f %8.2f\n", name, e->max, e->total/e->count, e->end);
+}
+
+// Picks the dither masks for 256 or 512 angles and reports their error, on stderr
+bool hires_build(int angles){
+    HiresError dithered={0}, real={0}, nearest={0};
+    int (*row)[2]=malloc(PATH_STEPS*sizeof(*row));
+
+    hires_angles=angles;
+    hires_sub=angles/PATH_ANGLES;
+    hires_mask[0]=0;
+    for(int f=1;f<hires_sub;f++)
+        hires_mask[f]=hires_dither(f);
+    for(int angle=0;angle<hires_angles;angle++){
+        int f=angle%hires_sub;
+        hires_walk(angle, hires_mask[f], NULL, &dithered);
+        linear_row(angle*2*M_PI/hires_angles, DISTANCE, PATH_STEPS, row);
+        hires_walk(angle, 0, row, &real);
+        hires_walk(angle, 2*f>hires_sub ? ~(uint64_t)0 : 0, NULL, &nearest);
+    }
+    free(row);
+    fprintf(stderr, "hires: %d angles, %d bytes of dither masks instead of %d for a %d angles PathAngleLUT\n", hires_angles,
+        hires_sub*HIRES_FRAMES/8, (hires_angles-PATH_ANGLES)*PATH_STEPS*2, hires_angles);
+    fprintf(stderr, "hires: pixel error against true trig over %d frames, all %d angles\n", HIRES_DRIFT, hires_angles);
+    fprintf(stderr, "hires: %-18s %8s %8s %8s\n", "", "max", "mean", "frame256");
+    hires_report_line("dithered", &dithered);
+    hires_report_line("real table", &real);
+    hires_report_line("nearest 128 row", &nearest);
+    return true;
+}
+
+void hires_print(bool delta){
+    int shape[2]={hires_sub, HIRES_FRAMES/8}, values[HIRES_MAX][HIRES_FRAMES/8];
+
+    for(int f=0;f<hires_sub;f++)
+        for(int i=0;i<HIRES_FRAMES/8;i++)
+            values[f][i]=hires_mask[f]>>(i*8)&0xff;
+    printf("// %d angles out of the %d PathAngleLUT rows. A fine angle is row angle/%d, and on the frames set in\n", hires_angles,
+        PATH_ANGLES, hires_sub);
+    printf("// PathDither[angle %% %d] the next row, so the bullet moves in between\n", hires_sub);
+    printf("#define PATH_HIRES_ANGLES %d\n", hires_angles);
+    printf("#define PATH_DITHER_FRAMES %d\n", HIRES_FRAMES);
+    emit_table("u8", "PathDither", "[PATH_HIRES_ANGLES/PATH_ANGLES][PATH_DITHER_FRAMES/8]", &values[0][0], shape, 2);
+
+    printf("// Delta of a bullet at angle 0 to PATH_HIRES_ANGLES-1 on frame, counted from its spawn. Frame wraps at\n");
+    printf("// PATH_DITHER_FRAMES, the step of the row is frame %% PATH_STEPS\n");
+    printf("static void PathHiresDelta(u16 angle, u8 frame, i8 *dx, i8 *dy){\n");
+    printf("    u8 a = angle >> %d, step = frame & (PATH_STEPS-1);\n", hires_sub==2 ? 1 : 2);
+    printf("    frame &= PATH_DITHER_FRAMES-1;\n");
+    printf("    if(PathDither[angle & %d][frame >> 3] & (1 << (frame & 7)))\n", hires_sub-1);
+    printf("        a = (a + 1) & %d;\n", PATH_ANGLES-1);
+    if(delta)
+        printf("    PathAngleDelta(a, step, dx, dy);\n");
+    else{
+        printf("    *dx = PathAngleLUT[a][step][0];\n");
+        printf("    *dy = PathAngleLUT[a][step][1];\n");
+    }
+    printf("}\n\n");
+}
+
+void hires_print_externs(void){
+    printf("extern %su8 PathDither[PATH_HIRES_ANGLES/PATH_ANGLES][PATH_DITHER_FRAMES/8];\n", emit_const("PathDither"));
+}
@@ -0,0 +1,167 @@
+#include <stdlib.h>
+#include <string.h>
+#include "generator.h"
+
+/*
+
+Page aligned layouts. The hot tables (the ones read for every bullet every frame) start at a 256 bytes boundary
+and are placed with SDCC __at(), so the Z80 builds an address by loading the page in H and the index in L,
+without any 16 bit arithmetic:
+
+    aos         PathAngleLUT[angle][step][2] as today, only aligned.           address = page + angle*32 + step*2
+    soa         PathAngleDX/DY[step][angle], two steps per page.                H = page + step/2, L = (step&1)*128 + angle
+    soa-page    PathAngleDX/DY[step][256], one step per page, rest is padding.  H = page + step, L = angle
+
+ShootingCircle is split the same way (ShootingCircleX/Y[radius][angle]), and aim_matrix is a page by itself.
+The cold table, DegreeToPathAngleLUT, is left for the linker to place.
+
+The report printed on stderr gives the padding of every layout, so they can be compared before choosing one.
+The addresses are absolute, so the game must keep its code and other data out of that range.
+
+*/
+
+#define LAYOUT_TABLES   8
+
+typedef struct LayoutTable{
+    const char  *type, *name, *dims;
+    int         shape[3], rank;
+    int         size;           // bytes, padding included
+    bool        hot;
+    int         *values;
+    int         addr, pad;      // pad = bytes lost before the next table
+}LayoutTable;
+
+static const char *layout_names[]={"none", "aos", "soa", "soa-page"};
+
+static void layout_add(LayoutTable *t, int *n, const char *type, const char *name, const char *dims, int d0, int d1, int d2, bool hot){
+    LayoutTable *l=&t[(*n)++];
+
+    memset(l, 0, sizeof(LayoutTable));
+    l->type=type;
+    l->name=name;
+    l->dims=dims;
+    l->shape[0]=d0;
+    l->shape[1]=d1;
+    l->shape[2]=d2;
+    l->rank=d2 ? 3 : d1 ? 2 : 1;
+    l->size=d0*(d1 ? d1 : 1)*(d2 ? d2 : 1);
+    l->hot=hot;
+    l->values=calloc(l->size, sizeof(int));
+}
+
+// Builds the tables of a layout from the generated data. Returns how many there are
+static int layout_build(int layout, LayoutTable *t){
+    int n=0, stride=layout==LAYOUT_SOA_PAGE ? 256 : PATH_ANGLES;
+    const char *path_dims=layout==LAYOUT_SOA_PAGE ? "[PATH_STEPS][256]" : "[PATH_STEPS][PATH_ANGLES]";
+    const char *circle_dims=layout==LAYOUT_SOA_PAGE ? "[3][256]" : "[3][PATH_ANGLES]";
+
+    layout_add(t, &n, "u8", "aim_matrix", "[256]", 256, 0, 0, true);
+    for(int i=0;i<256;i++)
+        t[n-1].values[i]=targeting16x16[i];
+    if(layout==LAYOUT_AOS){
+        layout_add(t, &n, "i8", "PathAngleLUT", "[PATH_ANGLES][PATH_STEPS][2]", PATH_ANGLES, PATH_STEPS, 2, true);
+        memcpy(t[n-1].values, path_angle_lut, sizeof(path_angle_lut));
+        layout_add(t, &n, "i8", "ShootingCircle", "[3][PATH_ANGLES][2]", 3, PATH_ANGLES, 2, true);
+        memcpy(t[n-1].values, shootingPoints, sizeof(shootingPoints));
+    }
+    else{
+        for(int axis=0;axis<2;axis++){
+            layout_add(t, &n, "i8", axis ? "PathAngleDY" : "PathAngleDX", path_dims, PATH_STEPS, stride, 0, true);
+            for(int step=0;step<PATH_STEPS;step++)
+                for(int i=0;i<PATH_ANGLES;i++)
+                    t[n-1].values[step*stride+i]=path_angle_lut[i][step][axis];
+        }
+        for(int axis=0;axis<2;axis++){
+            layout_add(t, &n, "i8", axis ? "ShootingCircleY" : "ShootingCircleX", circle_dims, 3, stride, 0, true);
+            for(int r=0;r<3;r++)
+                for(int i=0;i<PATH_ANGLES;i++)
+                    t[n-1].values[r*stride+i]=shootingPoints[r][i][axis];
+        }
+    }
+    layout_add(t, &n, "u8", "DegreeToPathAngleLUT", "[360]", 360, 0, 0, false);
+    for(int i=0;i<360;i++)
+        t[n-1].values[i]=angle_to_lut[i];
+    return n;
+}
+
+// Gives an address to every hot table, each on a page boundary. Returns the size of the range they use
+static int layout_place(LayoutTable *t, int n, int base){
+    int addr=base;
+
+    for(int i=0;i<n;i++){
+        if(!t[i].hot)
+            continue;
+        t[i].addr=addr;
+        addr+=t[i].size;
+        if(addr&255){
+            t[i].pad=256-(addr&255);
+            addr+=t[i].pad;
+        }
+    }
+    return addr-base;
+}
+
+static void layout_free(LayoutTable *t, int n){
+    for(int i=0;i<n;i++)
+        free(t[i].values);
+}
+
+// Padding lost inside the tables: the unused half of every soa-page row
+static int layout_row_padding(int layout, const LayoutTable *t){
+    if(layout!=LAYOUT_SOA_PAGE || !t->hot || t->rank!=2)
+        return 0;
+    return t->shape[0]*(256-PATH_ANGLES);
+}
+
+// Prints the size and the padding of the hot tables in the three layouts on stderr
+void layout_report(int base){
+    LayoutTable t[LAYOUT_TABLES];
+
+    fprintf(stderr, "layout: %-9s %6s %6s %6s  %s\n", "", "data", "pad", "total", "range");
+    for(int layout=LAYOUT_AOS;layout<=LAYOUT_SOA_PAGE;layout++){
+        int n=layout_build(layout, t), total=layout_place(t, n, base), pad=0;
+        for(int i=0;i<n;i++)
+            pad+=t[i].pad+layout_row_padding(layout, &t[i]);
+        fprintf(stderr, "layout: %-9s %6d %6d %6d  0x%04X-0x%04X%s\n", layout_names[layout], total-pad, pad, total, base, base+total-1,
+            layout==options.layout ? "  <- printed" : "");
+        layout_free(t, n);
+    }
+}
+
+// Prints every table of the layout, placed with __at()
+void layout_print(int layout, int base){
+    LayoutTable t[LAYOUT_TABLES];
+    int n=layout_build(layout, t);
+    char type[32];
+
+    layout_place(t, n, base);
+    printf("// Tables placed by --layout=%s from 0x%04X, hot tables start on a 256 bytes page\n", layout_names[layout], base);
+    for(int i=0;i<n;i++){
+        if(t[i].hot)
+            printf("#define %s_PAGE 0x%02X\n", t[i].name, t[i].addr>>8);
+    }
+    printf("\n");
+    for(int i=0;i<n;i++){
+        if(t[i].hot)
+            snprintf(type, sizeof(type), "%s __at(0x%04X)", t[i].type, t[i].addr);
+        else
+            snprintf(type, sizeof(type), "%s", t[i].type);
+        emit_table(type, t[i].name, t[i].dims, t[i].values, t[i].shape, t[i].rank);
+    }
+    for(int i=0;i<n;i++)
+        printf("extern const %s %s%s;\n", t[i].type, t[i].name, t[i].dims);
+    layout_free(t, n);
+}
+
+// Address of a hot table of the layout placed from base, -1 if the layout hasn't it
+int layout_address(int layout, int base, const char *name){
+    LayoutTable t[LAYOUT_TABLES];
+    int n=layout_build(layout, t), addr=-1;
+
+    layout_place(t, n, base);
+    for(int i=0;i<n;i++)
+        if(t[i].hot && !strcmp(t[i].name, name))
+            addr=t[i].addr;
+    layout_free(t, n);
+    return addr;
+}
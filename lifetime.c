@@ -0,0 +1,168 @@
+#include <stdlib.h>
+#include "generator.h"
+
+/*
+
+Despawn scheduling for the PathAngleLUT bullets. A bullet moving along a row leaves the screen at a frame that
+only depends on where it was spawned and its angle, and the two axes are independent: x only moves by the dx of
+the row, y by the dy. So instead of a 2D table there's one per axis, with the spawn position quantized to Q pixels:
+
+    PathExitX[x / Q][angle]     frames until x leaves 0-255
+    PathExitY[y / Q][angle]     frames until y leaves 0-191
+
+and the bullet is gone after the smaller of the two. Every entry is the latest exit of the Q positions of its cell,
+so a bullet is never despawned while on the screen. That alone is up to Q/v frames late along an axis moving v
+pixels per frame, over 100 frames for the slow axis of a shallow angle. So each angle and axis also has a rate,
+frames per pixel, taken off for every pixel the spawn is past the slow end of its cell (the low end when the
+bullet moves towards 255, the high end when it moves towards 0):
+
+    PathExitX[x / Q][angle] - d * PathExitRate[angle][0]      d = x % Q or Q-1 - x % Q
+
+The rate is the largest that keeps every position of every cell on time, so the bullet is still never early.
+255 means it never leaves on that axis (it doesn't move along it, or takes longer than 254 frames), and gets no
+rate.
+
+PathExtent[angle] is the displacement of a whole row, PATH_STEPS frames, for engines that check the bounds once
+per row instead.
+
+*/
+
+#define SCREEN_WIDTH    256
+#define SCREEN_HEIGHT   192
+#define LIFETIME_NEVER  255
+
+static int lifetime_cell;
+static int (*exit_x)[PATH_ANGLES], (*exit_y)[PATH_ANGLES];
+static int exit_rate[PATH_ANGLES][2];
+
+// Pixels from the slow end of the cell, where the entry is the exact exit
+static int lifetime_offset(int pos, int angle, int axis){
+    int extent=0;
+
+    for(int s=0;s<PATH_STEPS;s++)
+        extent+=path_angle_lut[angle][s][axis];
+    return extent<0 ? lifetime_cell-1-pos%lifetime_cell : pos%lifetime_cell;
+}
+
+// Frames until a bullet at position pos leaves 0 to size-1 along axis
+static int lifetime_exit(int pos, int angle, int axis, int size){
+    for(int frame=0;frame<LIFETIME_NEVER;frame++){
+        pos+=path_angle_lut[angle][frame%PATH_STEPS][axis];
+        if(pos<0 || pos>=size)
+            return frame+1;
+    }
+    return LIFETIME_NEVER;
+}
+
+static void lifetime_axis(int (*table)[PATH_ANGLES], int axis, int size){
+    for(int a=0;a<PATH_ANGLES;a++)
+        exit_rate[a][axis]=LIFETIME_NEVER;
+    for(int c=0;c<size/lifetime_cell;c++)
+        for(int a=0;a<PATH_ANGLES;a++){
+            table[c][a]=0;
+            for(int pos=c*lifetime_cell;pos<(c+1)*lifetime_cell;pos++){
+                int frames=lifetime_exit(pos, a, axis, size);
+                table[c][a]=frames>table[c][a] ? frames : table[c][a];
+            }
+            if(table[c][a]==LIFETIME_NEVER)
+                continue;
+            for(int pos=c*lifetime_cell;pos<(c+1)*lifetime_cell;pos++){
+                int d=lifetime_offset(pos, a, axis), rate;
+                if(!d)
+                    continue;
+                rate=(table[c][a]-lifetime_exit(pos, a, axis, size))/d;
+                exit_rate[a][axis]=rate<exit_rate[a][axis] ? rate : exit_rate[a][axis];
+            }
+        }
+}
+
+// Frames scheduled along axis, what PathLifetime() computes
+static int lifetime_scheduled(int (*table)[PATH_ANGLES], int pos, int angle, int axis){
+    int frames=table[pos/lifetime_cell][angle];
+
+    return frames==LIFETIME_NEVER ? frames : frames-lifetime_offset(pos, angle, axis)*exit_rate[angle][axis];
+}
+
+// Builds the exit tables for cells of cell pixels and checks them on every spawn point, reported on stderr
+bool lifetime_build(int cell){
+    long late=0, bullets=0, frames=0, cell_late=0;
+    int worst=0, cell_worst=0;
+
+    lifetime_cell=cell;
+    exit_x=malloc(SCREEN_WIDTH/cell*sizeof(*exit_x));
+    exit_y=malloc(SCREEN_HEIGHT/cell*sizeof(*exit_y));
+    lifetime_axis(exit_x, 0, SCREEN_WIDTH);
+    lifetime_axis(exit_y, 1, SCREEN_HEIGHT);
+    for(int x=0;x<SCREEN_WIDTH;x+=3)
+        for(int y=0;y<SCREEN_HEIGHT;y+=3)
+            for(int a=0;a<PATH_ANGLES;a++){
+                int fx=lifetime_exit(x, a, 0, SCREEN_WIDTH), fy=lifetime_exit(y, a, 1, SCREEN_HEIGHT);
+                int real=fx<fy ? fx : fy, tx=lifetime_scheduled(exit_x, x, a, 0), ty=lifetime_scheduled(exit_y, y, a, 1);
+                int scheduled=tx<ty ? tx : ty, cx=exit_x[x/cell][a], cy=exit_y[y/cell][a], cell_only=cx<cy ? cx : cy;
+                if(scheduled<real){
+                    fprintf(stderr, "lifetime: a bullet at (%d, %d) angle %d leaves after %d frames, despawned after %d\n", x, y, a,
+                        real, scheduled);
+                    return false;
+                }
+                if(real==LIFETIME_NEVER)
+                    continue;
+                late+=scheduled-real;
+                worst=scheduled-real>worst ? scheduled-real : worst;
+                cell_late+=cell_only-real;
+                cell_worst=cell_only-real>cell_worst ? cell_only-real : cell_worst;
+                frames+=real;
+                bullets++;
+            }
+    fprintf(stderr, "lifetime: %d pixels cells, %d bytes, bullets live %.1f frames on average, despawned %.2f frames late on average, %d at most\n",
+        cell, (SCREEN_WIDTH+SCREEN_HEIGHT)/cell*PATH_ANGLES+PATH_ANGLES*4, frames/(double)bullets, late/(double)bullets, worst);
+    fprintf(stderr, "lifetime: without PathExitRate %.2f frames late on average, %d at most\n", cell_late/(double)bullets, cell_worst);
+    return true;
+}
+
+void lifetime_print(void){
+    int shape[2]={SCREEN_WIDTH/lifetime_cell, PATH_ANGLES}, extent[PATH_ANGLES][2]={{0}};
+
+    for(int a=0;a<PATH_ANGLES;a++)
+        for(int s=0;s<PATH_STEPS;s++){
+            extent[a][0]+=path_angle_lut[a][s][0];
+            extent[a][1]+=path_angle_lut[a][s][1];
+        }
+    printf("// Displacement of a whole PathAngleLUT row, PATH_STEPS frames\n");
+    shape[0]=PATH_ANGLES;
+    shape[1]=2;
+    emit_table("i8", "PathExtent", "[PATH_ANGLES][2]", &extent[0][0], shape, 2);
+    printf("// Frames until a PathAngleLUT bullet leaves the screen, by spawn position / PATH_EXIT_CELL and angle. %d never\n",
+        LIFETIME_NEVER);
+    printf("#define PATH_EXIT_CELL %d\n", lifetime_cell);
+    shape[1]=PATH_ANGLES;
+    shape[0]=SCREEN_WIDTH/lifetime_cell;
+    emit_table("u8", "PathExitX", "[256/PATH_EXIT_CELL][PATH_ANGLES]", &exit_x[0][0], shape, 2);
+    shape[0]=SCREEN_HEIGHT/lifetime_cell;
+    emit_table("u8", "PathExitY", "[192/PATH_EXIT_CELL][PATH_ANGLES]", &exit_y[0][0], shape, 2);
+    printf("// Frames per pixel taken off the exits above for every pixel past the slow end of the cell, by angle and axis\n");
+    shape[0]=PATH_ANGLES;
+    shape[1]=2;
+    emit_table("u8", "PathExitRate", "[PATH_ANGLES][2]", &exit_rate[0][0], shape, 2);
+    printf("// Frames to live of a bullet spawned at (x, y), y below 192. The frame to despawn it is the spawn frame plus this\n");
+    printf("static u8 PathLifetime(u8 x, u8 y, u8 angle){\n");
+    printf("    u8 fx = PathExitX[x / PATH_EXIT_CELL][angle], fy = PathExitY[y / PATH_EXIT_CELL][angle];\n");
+    printf("    u8 dx = x %% PATH_EXIT_CELL, dy = y %% PATH_EXIT_CELL;\n");
+    printf("    // the slow end is the low one when the row moves towards 255\n");
+    printf("    if(PathExtent[angle][0] < 0)\n");
+    printf("        dx = PATH_EXIT_CELL-1 - dx;\n");
+    printf("    if(PathExtent[angle][1] < 0)\n");
+    printf("        dy = PATH_EXIT_CELL-1 - dy;\n");
+    printf("    if(fx != %d)\n", LIFETIME_NEVER);
+    printf("        fx -= (u16)dx * PathExitRate[angle][0];\n");
+    printf("    if(fy != %d)\n", LIFETIME_NEVER);
+    printf("        fy -= (u16)dy * PathExitRate[angle][1];\n");
+    printf("    return fx < fy ? fx : fy;\n");
+    printf("}\n\n");
+}
+
+void lifetime_print_externs(void){
+    printf("extern %si8 PathExtent[PATH_ANGLES][2];\n", emit_const("PathExtent"));
+    printf("extern %su8 PathExitX[256/PATH_EXIT_CELL][PATH_ANGLES];\n", emit_const("PathExitX"));
+    printf("extern %su8 PathExitY[192/PATH_EXIT_CELL][PATH_ANGLES];\n", emit_const("PathExitY"));
+    printf("extern %su8 PathExitRate[PATH_ANGLES][2];\n", emit_const("PathExitRate"));
+}
@@ -0,0 +1,132 @@
+#include <math.h>
+#include <stdlib.h>
+#include "generator.h"
+
+/*
+
+Cumulative paths. PathOffset[angle][frame] is where a bullet is after frame+1 steps of DISTANCE pixels, relative
+to where it was spawned, so a bullet only needs its origin, angle and frame:
+
+    x = origin_x + PathOffset[angle][frame][0];
+    y = origin_y + PathOffset[angle][frame][1];
+
+Any frame can be read directly (seek, rewind, recompute after flicker culling), and nothing adds up. The first
+PATH_STEPS frames are the running sums of the PathAngleLUT rows as printed, --round ones included, so a bullet
+can switch between the two. The frames after them are rounded from the exact distance by linear_row(), moved by
+where the last row ends against it (nothing, unless --round-free lets the row end elsewhere).
+
+The offsets fit i8 up to 127 pixels from the origin, the table is i16 beyond that. It must fit a 16 KB ROM page, so
+at DISTANCE 2 the full table stops at 63 frames, the folded ones go further. With --fold only the first
+quadrant or octant is stored and PathOffsetAt() rotates it the way PathAngleDelta() does.
+
+*/
+
+#define OFFSETS_MAX_BYTES   16384   // an ascii16 ROM page, the biggest one
+
+static int offsets_frames, offsets_max;
+static int (*offsets)[2];       // [PATH_ANGLES][frames][2]
+
+static const char *offsets_type(void){
+    return offsets_max>127 ? "i16" : "i8";
+}
+
+// Offset of angle at frame rebuilt from the stored rows, the way PathOffsetAt() does it
+static void offsets_fold(int mode, int angle, int frame, int *dx, int *dy){
+    int a=angle&(ANGLES_PER_QUADRANT-1), x, y;
+
+    if(mode==FOLD_OCTANT && a>ANGLES_PER_QUADRANT/2){
+        x=offsets[(ANGLES_PER_QUADRANT-a)*offsets_frames+frame][1];
+        y=offsets[(ANGLES_PER_QUADRANT-a)*offsets_frames+frame][0];
+    }
+    else{
+        x=offsets[a*offsets_frames+frame][0];
+        y=offsets[a*offsets_frames+frame][1];
+    }
+    fold_rotate(angle, x, y, dx, dy);
+}
+
+// Computes the offsets of frames steps and checks them against the fold, on stderr
+bool offsets_build(int frames, int fold){
+    int (*row)[2]=malloc(frames*sizeof(*row)), rows=fold==FOLD_NONE ? PATH_ANGLES : fold_rows(fold);
+
+    offsets_frames=frames;
+    offsets=malloc(PATH_ANGLES*frames*sizeof(*offsets));
+    for(int i=0;i<PATH_ANGLES;i++){
+        int x=0, y=0, sx=0, sy=0;
+        linear_row(i*2*M_PI/PATH_ANGLES, DISTANCE, frames, row);
+        for(int f=0;f<frames;f++){
+            x+=row[f][0];
+            y+=row[f][1];
+            if(f<PATH_STEPS){
+                sx+=path_angle_lut[i][f][0]-row[f][0];
+                sy+=path_angle_lut[i][f][1]-row[f][1];
+            }
+            offsets[i*frames+f][0]=x+sx;
+            offsets[i*frames+f][1]=y+sy;
+            offsets_max=abs(x+sx)>offsets_max ? abs(x+sx) : offsets_max;
+            offsets_max=abs(y+sy)>offsets_max ? abs(y+sy) : offsets_max;
+        }
+    }
+    free(row);
+    for(int i=0;i<PATH_ANGLES && fold!=FOLD_NONE;i++)
+        for(int f=0;f<frames;f++){
+            int dx, dy;
+            offsets_fold(fold, i, f, &dx, &dy);
+            if(dx!=offsets[i*frames+f][0] || dy!=offsets[i*frames+f][1]){
+                fprintf(stderr, "offsets: angle %d frame %d rebuilt as (%d, %d) instead of (%d, %d)\n", i, f, dx, dy,
+                    offsets[i*frames+f][0], offsets[i*frames+f][1]);
+                return false;
+            }
+        }
+    if(rows*frames*2*(offsets_max>127 ? 2 : 1)>OFFSETS_MAX_BYTES){
+        fprintf(stderr, "offsets: %d frames take %d bytes, more than a %d bytes page, use fewer frames or --fold\n", frames,
+            rows*frames*2*(offsets_max>127 ? 2 : 1), OFFSETS_MAX_BYTES);
+        return false;
+    }
+    fprintf(stderr, "offsets: %d frames, up to %d pixels from the origin, %s, %d bytes\n", frames, offsets_max, offsets_type(),
+        rows*frames*2*(offsets_max>127 ? 2 : 1));
+    return true;
+}
+
+void offsets_print(int fold){
+    int shape[3]={fold==FOLD_NONE ? PATH_ANGLES : fold_rows(fold), offsets_frames, 2};
+    const char *type=offsets_type();
+
+    printf("// Position after frame+1 steps of %d pixels, relative to the origin of the bullet\n", DISTANCE);
+    printf("#define PATH_OFFSET_FRAMES %d\n", offsets_frames);
+    if(fold==FOLD_NONE){
+        printf("// x = origin x + PathOffset[angle][frame][0], y = origin y + PathOffset[angle][frame][1]\n");
+        emit_table(type, "PathOffset", "[PATH_ANGLES][PATH_OFFSET_FRAMES][2]", &offsets[0][0], shape, 3);
+        return;
+    }
+    printf("// PathOffset folded to the first %s, use PathOffsetAt() to read it\n", fold==FOLD_OCTANT ? "octant" : "quadrant");
+    printf("#define PATH_OFFSET_ROWS %d\n", shape[0]);
+    emit_table(type, "PathOffsetFold", "[PATH_OFFSET_ROWS][PATH_OFFSET_FRAMES][2]", &offsets[0][0], shape, 3);
+    printf("// x = origin x + *dx, y = origin y + *dy\n");
+    printf("static void PathOffsetAt(u8 angle, u8 frame, %s *dx, %s *dy){\n", type, type);
+    printf("    u8 a = angle & %d;\n", ANGLES_PER_QUADRANT-1);
+    printf("    %s x, y;\n", type);
+    if(fold==FOLD_OCTANT){
+        printf("    if(a > %d){\n", ANGLES_PER_QUADRANT/2);
+        printf("        x = PathOffsetFold[%d - a][frame][1];\n", ANGLES_PER_QUADRANT);
+        printf("        y = PathOffsetFold[%d - a][frame][0];\n", ANGLES_PER_QUADRANT);
+        printf("    }\n");
+        printf("    else{\n");
+        printf("        x = PathOffsetFold[a][frame][0];\n");
+        printf("        y = PathOffsetFold[a][frame][1];\n");
+        printf("    }\n");
+    }
+    else{
+        printf("    x = PathOffsetFold[a][frame][0];\n");
+        printf("    y = PathOffsetFold[a][frame][1];\n");
+    }
+    fold_print_rotation();
+    printf("}\n\n");
+}
+
+void offsets_print_externs(int fold){
+    if(fold==FOLD_NONE)
+        printf("extern %s%s PathOffset[PATH_ANGLES][PATH_OFFSET_FRAMES][2];\n", emit_const("PathOffset"), offsets_type());
+    else
+        printf("extern %s%s PathOffsetFold[PATH_OFFSET_ROWS][PATH_OFFSET_FRAMES][2];\n", emit_const("PathOffsetFold"), offsets_type());
+}
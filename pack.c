@@ -0,0 +1,135 @@
+#include <stdlib.h>
+#include "generator.h"
+
+/*
+
+Every PathAngleLUT delta is between -2 and 2, and inside a quadrant the signs never change: x and y only move
+away from the origin. So a step is stored as the magnitudes |dx| (bits 0-1) and |dy| (bits 2-3) in a nibble,
+two steps per byte (even step in the low nibble), and the signs come from the quadrant:
+
+     |
+  2  |  3        quadrant 0: ( dx,  dy)     quadrant 2: (-dx, -dy)
+-----|-----      quadrant 1: (-dx,  dy)     quadrant 3: ( dx, -dy)
+  1  |  0
+     |
+
+When the table is also folded, only the first quadrant is stored and it is rotated like PathAngleFold.
+
+*/
+
+#define PACK_BYTES  (PATH_STEPS/2)
+
+static uint8_t packed[PATH_ANGLES][PACK_BYTES];
+
+static int pack_rows(int fold){
+    return fold==FOLD_NONE ? PATH_ANGLES : fold_rows(fold);
+}
+
+// Host side copy of the routine printed by pack_print()
+static void pack_delta(int fold, int angle, int step, int *dx, int *dy){
+    int a=angle&(ANGLES_PER_QUADRANT-1), row=angle, x, y, n, t;
+    bool swap=false;
+
+    if(fold!=FOLD_NONE)
+        row=a;
+    if(fold==FOLD_OCTANT && a>ANGLES_PER_QUADRANT/2){
+        row=ANGLES_PER_QUADRANT-a;
+        swap=true;
+    }
+    n=packed[row][step>>1];
+    if(step&1)
+        n>>=4;
+    x=n&3;
+    y=(n>>2)&3;
+    if(swap){
+        t=x;
+        x=y;
+        y=t;
+    }
+    if(fold!=FOLD_NONE)
+        fold_rotate(angle, x, y, dx, dy);
+    else{
+        int q=(angle/ANGLES_PER_QUADRANT)&3;
+        *dx=(q==1 || q==2) ? -x : x;
+        *dy=(q>=2) ? -y : y;
+    }
+}
+
+// Packs path_angle_lut and decodes every angle and step back, so a delta that doesn't fit the nibble or breaks
+// the sign rule is caught here instead of in the game
+bool pack_verify(int fold){
+    int rows=pack_rows(fold), dx, dy;
+
+    for(int i=0;i<rows;i++)
+        for(int step=0;step<PATH_STEPS;step++){
+            int mx=abs(path_angle_lut[i][step][0]), my=abs(path_angle_lut[i][step][1]);
+            if(mx>3 || my>3){
+                fprintf(stderr, "pack: angle %d step %d delta (%d, %d) doesn't fit in 2 bits per axis\n", i, step,
+                    path_angle_lut[i][step][0], path_angle_lut[i][step][1]);
+                return false;
+            }
+            packed[i][step>>1]|=(mx|(my<<2))<<((step&1)*4);
+        }
+    for(int i=0;i<PATH_ANGLES;i++)
+        for(int step=0;step<PATH_STEPS;step++){
+            pack_delta(fold, i, step, &dx, &dy);
+            if(dx!=path_angle_lut[i][step][0] || dy!=path_angle_lut[i][step][1]){
+                fprintf(stderr, "pack: angle %d step %d decodes as (%d, %d), PathAngleLUT has (%d, %d)\n", i, step, dx, dy,
+                    path_angle_lut[i][step][0], path_angle_lut[i][step][1]);
+                return false;
+            }
+        }
+    fprintf(stderr, "pack: nibble decode is lossless for all %d angles and %d steps, %d bytes instead of %d\n", PATH_ANGLES, PATH_STEPS,
+        rows*PACK_BYTES, PATH_ANGLES*PATH_STEPS*2);
+    return true;
+}
+
+// Prints the packed table and the SDCC routine that decodes it. pack_verify() must have been called before
+void pack_print(int fold){
+    int shape[2]={pack_rows(fold), PACK_BYTES}, values[PATH_ANGLES*PACK_BYTES];
+
+    for(int i=0;i<shape[0];i++)
+        for(int j=0;j<PACK_BYTES;j++)
+            values[i*PACK_BYTES+j]=packed[i][j];
+    printf("// PathAngleLUT packed as |dx| | |dy|<<2 per nibble, even steps in the low nibble. Use PathAngleDelta() to read it\n");
+    printf("#define PATH_PACKED_ROWS %d\n", shape[0]);
+    emit_table("u8", "PathAnglePacked", "[PATH_PACKED_ROWS][PATH_STEPS/2]", values, shape, 2);
+
+    printf("// Same as dx=PathAngleLUT[angle][step][0], dy=PathAngleLUT[angle][step][1]\n");
+    printf("static void PathAngleDelta(u8 angle, u8 step, i8 *dx, i8 *dy){\n");
+    printf("    u8 a = angle & %d, n;\n", ANGLES_PER_QUADRANT-1);
+    printf("    i8 x, y;\n");
+    if(fold==FOLD_NONE)
+        printf("    n = PathAnglePacked[angle][step >> 1];\n");
+    else if(fold==FOLD_QUADRANT)
+        printf("    n = PathAnglePacked[a][step >> 1];\n");
+    else
+        printf("    n = PathAnglePacked[a > %d ? %d - a : a][step >> 1];\n", ANGLES_PER_QUADRANT/2, ANGLES_PER_QUADRANT);
+    printf("    if(step & 1)\n");
+    printf("        n >>= 4;\n");
+    if(fold==FOLD_OCTANT){
+        printf("    if(a > %d){\n", ANGLES_PER_QUADRANT/2);
+        printf("        x = (n >> 2) & 3;\n");
+        printf("        y = n & 3;\n");
+        printf("    }\n");
+        printf("    else{\n");
+        printf("        x = n & 3;\n");
+        printf("        y = (n >> 2) & 3;\n");
+        printf("    }\n");
+    }
+    else{
+        printf("    x = n & 3;\n");
+        printf("    y = (n >> 2) & 3;\n");
+    }
+    if(fold==FOLD_NONE){
+        printf("    switch(angle / %d){\n", ANGLES_PER_QUADRANT);
+        printf("        case 0:  *dx =  x; *dy =  y; break;\n");
+        printf("        case 1:  *dx = -x; *dy =  y; break;\n");
+        printf("        case 2:  *dx = -x; *dy = -y; break;\n");
+        printf("        default: *dx =  x; *dy = -y; break;\n");
+        printf("    }\n");
+    }
+    else
+        fold_print_rotation();
+    printf("}\n\n");
+}
@@ -3,14 +3,9 @@
 #include <stdint.h>
 #include <math.h>
 #include <stdlib.h>
+#include <string.h>
 #include <stdbool.h>
-
-#define DEBUG               false
-#define PATH_STEPS          16      // Enough to move through 32 pixels at 1 pixels speed
-#define PATH_ANGLES         128     // there should be 120 angles stored in the structure
-#define DISTANCE            2
-#define ANGLES_PER_QUADRANT 32
-#define SPIDER_STEPS        30
+#include "generator.h"
 
 /*
 
@@ -48,23 +43,446 @@ dividing 360 degrees in 128 parts (angle_to_lut), which is useful for getting fi
 // Contains 64 angles, with 16 movements of 2 pixels each, with the delta stored as (dx,dy) for the 4th quadrand (315 to 360 degrees)/
 // All other quadrants are calculated by swapping x by y and changing the sign
 int path_angle_lut[PATH_ANGLES][PATH_STEPS][2];
+// Zero for everything not set here: no fold, no layout, C backend tables, no report
+Options options = {.page_base=0x8000, .backend=BACKEND_C, .out=".", .mapper=MAPPER_NONE, .first_bank=-1, .replay_share=50};
 uint8_t angle_to_lut[360];   // First index is the index into the Lut, the other 2 are the multiplication factor for x and y
 uint8_t targeting16x16[256];
 int shootingPoints[3][PATH_ANGLES][2];
-int path_spider[SPIDER_STEPS];
-int path_spider_up[SPIDER_STEPS];
-//int  path_circle[7][1024][2];
-//double double_circle[1024][2];
 
-//int path_circle_steps[7];
+// Deltas of a straight line at angle (radians), moving speed pixels per step. Each step is the difference between
+// the rounded distances from the origin, so the rounding errors never add up inside a row
+void linear_row(double angle, double speed, int steps, int (*row)[2]){
+    int px=0, py=0, cx, cy;
+
+    for(int step=0;step<steps;step++){
+        cx = lround(cos(angle)*((step+1)*speed));
+        row[step][0]= cx - px;
+        px = cx;
+        cy=lround(sin(angle)*((step+1)*speed));
+        row[step][1] = cy-py;
+        py=cy;
+    }
+}
+
+// Speed as used in #defines and table names: 1.5 -> 1_5
+void speed_name(double speed, char *name, int size){
+    snprintf(name, size, "%g", speed);
+    for(char *c=name;*c;c++)
+        if(*c=='.')
+            *c='_';
+}
+
+// The legacy printers below keep the header as it always was. The other backends and --compress get the tables
+// through emit_table()
+void print_aim_matrix(){
+    if(emit_routed("aim_matrix")){
+        int shape[1]={256}, values[256];
+        for(int i=0;i<256;i++)
+            values[i]=targeting16x16[i];
+        emit_table("u8", "aim_matrix", "[256]", values, shape, 1);
+        return;
+    }
+    // Print the targeting 256 bytes lookup table
+    printf("// 16x16 Aiming Matrix for 128-Angle System\n");
+    printf("// Layout: Left to Right (dx 0-15), Top to Bottom (dy 0-15)\n");
+    printf("const u8 aim_matrix[256] = {\n");
+    for (int dy = 0; dy < 16; dy++) {
+        printf("    ");
+        for (int dx = 0; dx < 16; dx++) {
+            printf("%2d,", targeting16x16[dx+16*dy]);
+        }
+        printf("\n");
+    }
+    printf("};\n\n"); 
+}
+
+void print_path_angle_lut(){
+    if(emit_routed("PathAngleLUT")){
+        int shape[3]={PATH_ANGLES, PATH_STEPS, 2};
+        emit_table("i8", "PathAngleLUT", "[PATH_ANGLES][PATH_STEPS][2]", &path_angle_lut[0][0][0], shape, 3);
+        return;
+    }
+    // Print the linear PATHS
+    printf("const   i8  PathAngleLUT[PATH_ANGLES][PATH_STEPS][2] ={\n\n");
+    for(int i=0;i<PATH_ANGLES;i++){
+        printf("    { ");
+        printf("// Angle: %d\n", (360*i)/128);
+        for(int j=0;j<PATH_STEPS;j++){
+            printf("{ %d, %d}", path_angle_lut[i][j][0], path_angle_lut[i][j][1]);
+            if(j!=PATH_STEPS-1)
+                printf(", ");
+        }
+        if(i!=PATH_ANGLES-1)
+            printf("},\n");
+        else
+            printf("}\n");
+    }
+    printf("};\n\n");
+}
+
+void print_degree_lut(){
+    if(emit_routed("DegreeToPathAngleLUT")){
+        int shape[1]={360}, values[360];
+        for(int i=0;i<360;i++)
+            values[i]=angle_to_lut[i];
+        emit_table("u8", "DegreeToPathAngleLUT", "[360]", values, shape, 1);
+        return;
+    }
+    printf("const   u8  DegreeToPathAngleLUT[360] ={\n");
+    for(int i=0;i<18;i++){
+        printf("    ");
+        for(int j=0;j<20;j++){
+            if(i==17 && j==19)
+                printf("%3d", angle_to_lut[i*20+j]);
+            else
+                printf("%3d, ", angle_to_lut[i*20+j]);
+        }
+        printf("\n");
+    }
+    printf("};\n\n");
+}
+
+void print_shooting_circle(){
+    if(emit_routed("ShootingCircle")){
+        int shape[3]={3, PATH_ANGLES, 2};
+        emit_table("i8", "ShootingCircle", "[3][PATH_ANGLES][2]", &shootingPoints[0][0][0], shape, 3);
+        return;
+    }
+    printf("const i8 ShootingCircle[3][%d][2]={ \n", PATH_ANGLES);  
+    for(int r=0;r<3;r++){
+        printf("    { ");
+        for(int a=0;a<128;a++){   
+            printf("{ %d, %d}", shootingPoints[r][a][0], shootingPoints[r][a][1]);
+            if(a!=127)
+                printf(", ");
+            else
+                printf(" ");
+                
+        }
+        if(r!=2)
+            printf("},\n");
+        else
+            printf("}\n");
+    }
+    printf("};\n\n");
+}
+
+static void usage(const char *name){
+    fprintf(stderr, "usage: %s [options] > shmup_lut.h\n", name);
+    fprintf(stderr, "  --fold=quadrant|octant   store one quadrant/octant of PathAngleLUT plus PathAngleDelta() to rebuild it\n");
+    fprintf(stderr, "  --pack=nibble            store PathAngleLUT as one nibble per step plus PathAngleDelta() to decode it\n");
+    fprintf(stderr, "  --round[=B]              choose the PathAngleLUT rows that pack smallest within B pixels of the line (0.5 to 1.5, 0.75)\n");
+    fprintf(stderr, "  --round-free             with --round, let the rows end anywhere within B instead of the lround end point\n");
+    fprintf(stderr, "  --bench                  run the table consumers on a Z80 model and print their T-states\n");
+    fprintf(stderr, "  --replay[=FILE]          replay a spawn trace (default a built-in script) and print the cost per frame of every mode\n");
+    fprintf(stderr, "  --replay-share=P         percent of the frame the bullets may take in the --replay report (default 50)\n");
+    fprintf(stderr, "  --sweep[=RANGES]         build every steps/angles/distance/aim/fold combination on all cores, print the Pareto frontier as CSV\n");
+    fprintf(stderr, "  --layout=aos|soa|soa-page  place the tables on 256 bytes pages with __at(), splitting dx/dy for soa\n");
+    fprintf(stderr, "  --page-base=ADDR         first address used by --layout (default 0x8000, must be page aligned)\n");
+    fprintf(stderr, "  --steppers[=U]           with --layout, write path_step.asm, a batch bullet stepper unrolled U times (1, 2, 4, 8, default 4)\n");
+    fprintf(stderr, "  --velocity=S1,S2,...     replace PathAngleLUT with 8.8 velocity tables for these speeds, with a drift report\n");
+    fprintf(stderr, "  --batch=S:N,S:N,...      replace PathAngleLUT with the first octant rows (quadrant with --fold) of N steps for every speed S, in a shared pool\n");
+    fprintf(stderr, "  --circles                also print circle paths for radii 16 to 112, one octant stored per radius\n");
+    fprintf(stderr, "  --offsets=N              also print PathOffset, the position after 1 to N steps from the origin (--fold applies)\n");
+    fprintf(stderr, "  --hires=256|512          also print PathDither and PathHiresDelta(), finer angles dithering two PathAngleLUT rows\n");
+    fprintf(stderr, "  --shooting[=R1,R2,...]   replace ShootingCircle with one u8 octant per radius, 4 to 128 pixels (default 8,16,32)\n");
+    fprintf(stderr, "  --patterns[=P1,P2,...]   also print spreadN:S, ringN and spiralN:R bullet patterns (default %s)\n",
+        "spread3:4,spread5:4,spread7:2,ring8,ring16,ring32,spiral8:2");
+    fprintf(stderr, "  --steer[=R:P,R:P,...]    also print SteerTable, turn rate R toward a target with profile P (constant or an ease)\n");
+    fprintf(stderr, "  --lifetime[=Q]           also print the frames until a bullet leaves the screen, spawn quantized to Q pixels (16)\n");
+    fprintf(stderr, "  --aim-report             print the error of 8x8 to 64x64 aim tables against atan2 instead of the header\n");
+    fprintf(stderr, "  --aim=N                  print an NxN aim_matrix (8, 16, 32 or 64) and AimAngle() to read it\n");
+    fprintf(stderr, "  --aim-shift=S            bits shifted per --aim normalization iteration (default log2 N)\n");
+    fprintf(stderr, "  --aim-log                also print AimLog/AimLogAngle and AimAngleLog(), aiming without the shift loop\n");
+    fprintf(stderr, "  --aim-row                also print AimRowLUT and AimRow(), aim_matrix cells straight to PathAngleLUT rows\n");
+    fprintf(stderr, "  --backend=c|asm|bin|split  where the tables go: the header (default), sjasm db source, one .bin or one .c per table\n");
+    fprintf(stderr, "  --out=DIR                directory of the asm/bin files (default .)\n");
+    fprintf(stderr, "  --megarom=ascii8|ascii16|konami  pack the asm/bin tables in ROM pages, hot tables sharing one, with a map\n");
+    fprintf(stderr, "  --first-bank=N           first ROM page used by --megarom (default 2 for 8 KB pages, 1 for 16 KB)\n");
+    fprintf(stderr, "  --compress=NAME,...      pack these tables with ZX0, to be unpacked to RAM at stage load, with a cost report\n");
+    fprintf(stderr, "  --spec=FILE              also print the paths described in FILE (- for stdin), see paths.spec\n");
+}
+
+// Reads a comma separated list of numbers, returns how many or -1 if the list is wrong
+static int parse_list(const char *text, double *values, int max){
+    int count=0;
+    char *end;
+
+    while(*text){
+        if(count==max)
+            return -1;
+        values[count++]=strtod(text, &end);
+        if(end==text || (*end && *end!=','))
+            return -1;
+        text=*end ? end+1 : end;
+    }
+    return count;
+}
+
+static bool parse_options(int argc, char *argv[]){
+    for(int i=1;i<argc;i++){
+        if(!strcmp(argv[i], "--fold=quadrant"))
+            options.fold=FOLD_QUADRANT;
+        else if(!strcmp(argv[i], "--fold=octant"))
+            options.fold=FOLD_OCTANT;
+        else if(!strcmp(argv[i], "--pack=nibble"))
+            options.pack=true;
+        else if(!strcmp(argv[i], "--bench"))
+            options.bench=true;
+        else if(!strcmp(argv[i], "--round"))
+            options.round=0.75;
+        else if(!strncmp(argv[i], "--round=", 8)){
+            options.round=atof(argv[i]+8);
+            if(options.round<0.5 || options.round>1.5){
+                fprintf(stderr, "%s: --round must be 0.5 to 1.5 pixels\n", argv[0]);
+                return false;
+            }
+        }
+        else if(!strcmp(argv[i], "--round-free"))
+            options.round_free=true;
+        else if(!strcmp(argv[i], "--replay"))
+            options.replay="";
+        else if(!strncmp(argv[i], "--replay=", 9))
+            options.replay=argv[i]+9;
+        else if(!strcmp(argv[i], "--sweep"))
+            options.sweep="";
+        else if(!strncmp(argv[i], "--sweep=", 8))
+            options.sweep=argv[i]+8;
+        else if(!strncmp(argv[i], "--replay-share=", 15)){
+            options.replay_share=atoi(argv[i]+15);
+            if(options.replay_share<1 || options.replay_share>100){
+                fprintf(stderr, "%s: --replay-share must be 1 to 100 percent\n", argv[0]);
+                return false;
+            }
+        }
+        else if(!strcmp(argv[i], "--layout=aos"))
+            options.layout=LAYOUT_AOS;
+        else if(!strcmp(argv[i], "--layout=soa"))
+            options.layout=LAYOUT_SOA;
+        else if(!strcmp(argv[i], "--layout=soa-page"))
+            options.layout=LAYOUT_SOA_PAGE;
+        else if(!strncmp(argv[i], "--velocity=", 11)){
+            options.nspeeds=parse_list(argv[i]+11, options.speeds, MAX_SPEEDS);
+            if(options.nspeeds<=0){
+                fprintf(stderr, "%s: --velocity needs 1 to %d speeds, like --velocity=1,1.5,2\n", argv[0], MAX_SPEEDS);
+                return false;
+            }
+            for(int s=0;s<options.nspeeds;s++)
+                if(options.speeds[s]<=0 || options.speeds[s]>=127){
+                    fprintf(stderr, "%s: speed %g doesn't fit an 8.8 velocity\n", argv[0], options.speeds[s]);
+                    return false;
+                }
+        }
+        else if(!strncmp(argv[i], "--batch=", 8)){
+            const char *text=argv[i]+8;
+            char *end;
+            options.nbatch=0;
+            while(*text){
+                BatchEntry *e=&options.batch[options.nbatch];
+                if(options.nbatch==MAX_SPEEDS)
+                    break;
+                e->speed=strtod(text, &end);
+                if(end==text || *end!=':')
+                    break;
+                text=end+1;
+                e->steps=strtol(text, &end, 10);
+                if(end==text || (*end && *end!=',') || e->speed<=0 || e->steps<1 || e->steps>256)
+                    break;
+                options.nbatch++;
+                text=*end ? end+1 : end;
+            }
+            if(*text || !options.nbatch){
+                fprintf(stderr, "%s: --batch needs 1 to %d speed:steps pairs, like --batch=1:32,2:16,3.5:16\n", argv[0], MAX_SPEEDS);
+                return false;
+            }
+        }
+        else if(!strcmp(argv[i], "--circles"))
+            options.circles=true;
+        else if(!strncmp(argv[i], "--offsets=", 10)){
+            options.offsets=atoi(argv[i]+10);
+            if(options.offsets<1 || options.offsets>256){
+                fprintf(stderr, "%s: --offsets must be 1 to 256 frames\n", argv[0]);
+                return false;
+            }
+        }
+        else if(!strcmp(argv[i], "--patterns"))
+            options.patterns="";
+        else if(!strncmp(argv[i], "--patterns=", 11))
+            options.patterns=argv[i]+11;
+        else if(!strcmp(argv[i], "--steer"))
+            options.steer="";
+        else if(!strncmp(argv[i], "--steer=", 8))
+            options.steer=argv[i]+8;
+        else if(!strncmp(argv[i], "--hires=", 8)){
+            options.hires=atoi(argv[i]+8);
+            if(options.hires!=256 && options.hires!=512){
+                fprintf(stderr, "%s: --hires must be 256 or 512 angles\n", argv[0]);
+                return false;
+            }
+        }
+        else if(!strcmp(argv[i], "--shooting"))
+            options.shooting="";
+        else if(!strncmp(argv[i], "--shooting=", 11))
+            options.shooting=argv[i]+11;
+        else if(!strcmp(argv[i], "--lifetime"))
+            options.lifetime=16;
+        else if(!strncmp(argv[i], "--lifetime=", 11)){
+            options.lifetime=atoi(argv[i]+11);
+            if(options.lifetime!=4 && options.lifetime!=8 && options.lifetime!=16 && options.lifetime!=32 && options.lifetime!=64){
+                fprintf(stderr, "%s: --lifetime must be 4, 8, 16, 32 or 64 pixels\n", argv[0]);
+                return false;
+            }
+        }
+        else if(!strcmp(argv[i], "--aim-report"))
+            options.aim_report=true;
+        else if(!strncmp(argv[i], "--aim=", 6)){
+            options.aim_size=atoi(argv[i]+6);
+            if(options.aim_size!=8 && options.aim_size!=16 && options.aim_size!=32 && options.aim_size!=64){
+                fprintf(stderr, "%s: --aim must be 8, 16, 32 or 64\n", argv[0]);
+                return false;
+            }
+        }
+        else if(!strncmp(argv[i], "--aim-shift=", 12)){
+            options.aim_shift=atoi(argv[i]+12);
+            if(options.aim_shift<1 || options.aim_shift>6){
+                fprintf(stderr, "%s: --aim-shift must be 1 to 6\n", argv[0]);
+                return false;
+            }
+        }
+        else if(!strcmp(argv[i], "--aim-log"))
+            options.aim_log=true;
+        else if(!strcmp(argv[i], "--aim-row"))
+            options.aim_row=true;
+        else if(!strcmp(argv[i], "--backend=c"))
+            options.backend=BACKEND_C;
+        else if(!strcmp(argv[i], "--backend=asm"))
+            options.backend=BACKEND_ASM;
+        else if(!strcmp(argv[i], "--backend=bin"))
+            options.backend=BACKEND_BIN;
+        else if(!strcmp(argv[i], "--backend=split"))
+            options.backend=BACKEND_SPLIT;
+        else if(!strncmp(argv[i], "--out=", 6) && argv[i][6])
+            options.out=argv[i]+6;
+        else if(!strcmp(argv[i], "--megarom=ascii8"))
+            options.mapper=MAPPER_ASCII8;
+        else if(!strcmp(argv[i], "--megarom=ascii16"))
+            options.mapper=MAPPER_ASCII16;
+        else if(!strcmp(argv[i], "--megarom=konami"))
+            options.mapper=MAPPER_KONAMI;
+        else if(!strncmp(argv[i], "--first-bank=", 13)){
+            options.first_bank=atoi(argv[i]+13);
+            if(options.first_bank<0 || options.first_bank>255){
+                fprintf(stderr, "%s: --first-bank must be 0 to 255\n", argv[0]);
+                return false;
+            }
+        }
+        else if(!strncmp(argv[i], "--compress=", 11) && argv[i][11])
+            options.compress=argv[i]+11;
+        else if(!strncmp(argv[i], "--spec=", 7) && argv[i][7])
+            options.spec=argv[i]+7;
+        else if(!strcmp(argv[i], "--steppers"))
+            options.steppers=4;
+        else if(!strncmp(argv[i], "--steppers=", 11)){
+            options.steppers=atoi(argv[i]+11);
+            if(options.steppers!=1 && options.steppers!=2 && options.steppers!=4 && options.steppers!=8){
+                fprintf(stderr, "%s: --steppers must be 1, 2, 4 or 8\n", argv[0]);
+                return false;
+            }
+        }
+        else if(!strncmp(argv[i], "--page-base=", 12)){
+            options.page_base=strtol(argv[i]+12, NULL, 0);
+            if(options.page_base&255 || options.page_base<0 || options.page_base>0xFF00){
+                fprintf(stderr, "%s: --page-base must be a multiple of 256 below 0x10000\n", argv[0]);
+                return false;
+            }
+        }
+        else{
+            fprintf(stderr, "%s: unknown option %s\n", argv[0], argv[i]);
+            usage(argv[0]);
+            return false;
+        }
+    }
+    if(options.mapper!=MAPPER_NONE && (options.backend==BACKEND_C || options.backend==BACKEND_SPLIT)){
+        fprintf(stderr, "%s: --megarom needs --backend=asm or --backend=bin\n", argv[0]);
+        return false;
+    }
+    if(options.first_bank<0)
+        options.first_bank=options.mapper==MAPPER_ASCII16 ? 1 : 2;
+    if(options.backend!=BACKEND_C && options.layout!=LAYOUT_NONE){
+        fprintf(stderr, "%s: --layout places the tables with __at(), use --megarom to place them with --backend\n", argv[0]);
+        return false;
+    }
+    if(options.round_free && !options.round){
+        fprintf(stderr, "%s: --round-free needs --round\n", argv[0]);
+        return false;
+    }
+    if(options.aim_shift && !options.aim_size){
+        fprintf(stderr, "%s: --aim-shift needs --aim\n", argv[0]);
+        return false;
+    }
+    if(options.aim_shift>aim_bits(options.aim_size)){
+        fprintf(stderr, "%s: --aim-shift can't be more than log2 of the --aim size\n", argv[0]);
+        return false;
+    }
+    if(!options.aim_shift)
+        options.aim_shift=aim_bits(options.aim_size);
+    if(options.aim_size && (options.layout!=LAYOUT_NONE || options.bench)){
+        fprintf(stderr, "%s: --aim can't be used with --layout or --bench, they expect the 16x16 aim_matrix\n", argv[0]);
+        return false;
+    }
+    if((options.spec || options.circles || options.aim_log || options.offsets || options.patterns ||
+        options.steer || options.lifetime || options.aim_row || options.shooting ||
+        options.hires) && (options.layout!=LAYOUT_NONE || options.bench)){
+        fprintf(stderr, "%s: --spec, --circles, --offsets, --patterns, --steer, --lifetime, --shooting, --hires, --aim-log and --aim-row can't be used with --layout or --bench\n", argv[0]);
+        return false;
+    }
+    if(options.aim_row && (options.aim_size || options.fold!=FOLD_NONE || options.pack || options.nbatch)){
+        fprintf(stderr, "%s: --aim-row points the 16x16 aim_matrix cells at PathAngleLUT or PathVelocity rows, it can't be used with --aim, --fold, --pack or --batch\n", argv[0]);
+        return false;
+    }
+    if(options.hires && (options.nspeeds || options.nbatch)){
+        fprintf(stderr, "%s: --hires dithers between PathAngleLUT rows, it can't be used with --velocity or --batch\n", argv[0]);
+        return false;
+    }
+    if(options.replay && (options.bench || options.aim_report || options.layout!=LAYOUT_NONE || options.aim_size)){
+        fprintf(stderr, "%s: --replay prints its own report with the --bench routines, it can't be used with --bench, --aim-report, --layout or --aim\n", argv[0]);
+        return false;
+    }
+    if(options.sweep && (options.bench || options.replay || options.aim_report || options.layout!=LAYOUT_NONE)){
+        fprintf(stderr, "%s: --sweep prints its own report, it can't be used with --bench, --replay, --aim-report or --layout\n", argv[0]);
+        return false;
+    }
+    if(options.compress && (options.layout!=LAYOUT_NONE || options.bench)){
+        fprintf(stderr, "%s: --compress can't be used with --layout or --bench\n", argv[0]);
+        return false;
+    }
+    if(options.steppers && (options.layout==LAYOUT_NONE || options.bench)){
+        fprintf(stderr, "%s: --steppers reads the page aligned tables of --layout, it needs --layout and can't be used with --bench\n", argv[0]);
+        return false;
+    }
+    if(options.layout!=LAYOUT_NONE && (options.fold!=FOLD_NONE || options.pack)){
+        fprintf(stderr, "%s: --layout places the full tables, it can't be used with --fold or --pack\n", argv[0]);
+        return false;
+    }
+    if(options.nspeeds && (options.fold!=FOLD_NONE || options.pack || options.layout!=LAYOUT_NONE)){
+        fprintf(stderr, "%s: --velocity replaces PathAngleLUT, it can't be used with --fold, --pack or --layout\n", argv[0]);
+        return false;
+    }
+    if(options.nbatch && (options.pack || options.layout!=LAYOUT_NONE || options.nspeeds)){
+        fprintf(stderr, "%s: --batch replaces PathAngleLUT, it can't be used with --pack, --layout or --velocity\n", argv[0]);
+        return false;
+    }
+    return true;
+}
 
-void main(){
+int main(int argc, char *argv[]){
     double dx[PATH_STEPS], dy[PATH_STEPS], angle;
     int x, y, degree, prevdegree=0, prevx, prevy;
 
+    if(!parse_options(argc, argv))
+        return 1;
     
     for (int dy = 0; dy < 16; dy++) {
-        printf("    ");
         for (int dx = 0; dx < 16; dx++) {
             int angle_index;
             
@@ -86,28 +504,19 @@ void main(){
         }
     }
 
-    int px, py, cx, cy;
     for(int i=0;i<PATH_ANGLES;i++){
-        px=0;
-        py=0;
         angle = i*2*M_PI/PATH_ANGLES;
         degree=lround((180*angle)/M_PI);
         if(DEBUG)
             printf("Degree: %d \n", degree);
-        // Calculates the distances from the origin (0, 0)
-        for(int step=0;step<PATH_STEPS;step++){
-
-            cx = lround(cos(angle)*((step+1)*DISTANCE));
-            path_angle_lut[i][step][0]= cx - px;
-            px = cx;
-            cy=lround(sin(angle)*((step+1)*DISTANCE));
-            path_angle_lut[i][step][1] = cy-py;
-            py=cy;
-            if(DEBUG)
+        linear_row(angle, DISTANCE, PATH_STEPS, path_angle_lut[i]);
+        if(DEBUG)
+            for(int step=0;step<PATH_STEPS;step++)
                printf("Entry: %d, Angle: %d, Step: %d: (%f, %f), (%d, %d)\n", i, degree, step, cos(angle)*((step+1)), sin(angle)*((step+1)), 
                 path_angle_lut[i][step][0], path_angle_lut[i][step][1]);
-        }
     }
+    if(options.round && !round_build(options.round, options.round_free))
+        return 1;
     for(int i=0;i<360;i++)
         angle_to_lut[i]=(128*i)/360; 
     if(DEBUG)
@@ -124,169 +533,136 @@ void main(){
                printf("Radius: %d, Step: %d, (%d, %d)\n", radius, i, shootingPoints[r][i][0], shootingPoints[r][i][1]);
         }
     }
-    // Calculates the circle movements, for several radii: 32, 64, 96, 128, 160, 192, 224
-    // Does it in the first 45 degrees in the 4th quadrant, and other quadrants and complementing 45 degrees are calculated by changing signs, and dx by dy
- /*   int radius_steps[6];
-    for(int r=0; r<7; r++){
-        // Calculates the perimeter for 360 degrees of the circle
-        double perimeter = 2*M_PI*(r+1)*16;
-        // We move two pixels distance each time, then we have perimeter/2 steps to do (the character is already at the initial position)
-        int steps=lround(perimeter/DISTANCE);
-        if(steps%4)
-            steps=steps+(4-steps%4);
-        path_circle_steps[r]=steps;
-        // Calculate the double values
-        int cx, cy, px=(r+1)*16, py=0;
-        for(int i=0;i<steps;i++){
-            angle = (2*M_PI*(i+1))/(double)steps;
-            double_circle[i][0]=cos(angle)*(double)(r+1)*16;
-            double_circle[i][1]=sin(angle)*(double)(r+1)*16;
-            cx=lround(double_circle[i][0]);
-            cy=lround(double_circle[i][1]);
-            path_circle[r][i][0]=cx-px;
-            path_circle[r][i][1]=cy-py;
-            px=cx;
-            py=cy;
-            if(DEBUG)
-                printf("Radius: %d, Steps: %d, Step: %d, (%f, %f)x(%d, %d)\n", (r+1)*16, steps, i, double_circle[i][0], 
-                    double_circle[i][1], path_circle[r][i][0], path_circle[r][i][1]);
-
-        }
-    }*/
-    // Calculate the spider downwards movement
-    int ycurrent=-31, next;
-    for(int i=0;i<SPIDER_STEPS;++i){
-        double  angle=(double)i*3*M_PI/180;
-        next=-31+86*sin(angle);
-        path_spider[i]=next-ycurrent;
-        if(next!=ycurrent)
-            ycurrent=next;
-        if(DEBUG)
-            printf("Spider: %d, y:%d\n", i, path_spider[i]);
-    }
-    // Calculate the spider upward movement
-    ycurrent=-31+86, next;
-    for(int i=0;i<SPIDER_STEPS;++i){
-        double  angle=(double)(29-i)*3*M_PI/180;
-        next=-31+86*sin(angle);
-        path_spider_up[i]=next-ycurrent;
-        if(next!=ycurrent)
-            ycurrent=next;
-        if(DEBUG)
-            printf("Spider: %d, y:%d\n", i, path_spider[i]);
+    if(options.bench)
+        return bench_report() ? 0 : 1;
+    if(options.replay)
+        return replay_report(options.replay, options.replay_share) ? 0 : 1;
+    if(options.sweep)
+        return sweep_report(options.sweep) ? 0 : 1;
+    if(options.aim_report){
+        aim_report();
+        return 0;
+    }
+    if(options.pack){
+        if(!pack_verify(options.fold))
+            return 1;
     }
+    else if(options.fold!=FOLD_NONE && !fold_verify(options.fold))
+        return 1;
+    if(options.nspeeds)
+        velocity_report(options.speeds, options.nspeeds);
+    if(options.circles && !circle_build())
+        return 1;
+    if(options.offsets && !offsets_build(options.offsets, options.fold))
+        return 1;
+    if(options.hires && !hires_build(options.hires))
+        return 1;
+    if(options.shooting && !shooting_build(options.shooting))
+        return 1;
+    if(options.patterns && !patterns_build(options.patterns))
+        return 1;
+    if(options.steer && !steer_build(options.steer))
+        return 1;
+    if(options.lifetime && !lifetime_build(options.lifetime))
+        return 1;
+    if(options.nbatch && !batch_build(options.batch, options.nbatch, options.fold))
+        return 1;
+    if(options.steppers && !stepper_build(options.page_base, options.steppers))
+        return 1;
     if(!DEBUG){
         // Prints the paths
 
-        /*printf("enum   CIRCLE_RADII    {RADIUS16, RADIUS32, RADIUS48, RADIUS64, RADIUS80, RADIUS96, RADIUS112, MAX_CIRCLE_RADII};\n\n");
-        printf("typedef struct CirclePath{\n");
-        printf("    i8  (*path)[2];\n");
-        printf("    u8  radius;\n");
-        printf("    u16 steps;\n");
-        printf("}CirclePath;\n\n");*/
-
         printf("#ifndef  PATHS_H\n#define PATHS_H\n\n");
-        printf("#define PATH_STEPS  %d\n#define PATH_ANGLES %d\n#define SPIDER_STEPS %d\n\n", PATH_STEPS, PATH_ANGLES, SPIDER_STEPS);
-        // Print the targeting 256 bytes lookup table
-        printf("// 16x16 Aiming Matrix for 128-Angle System\n");
-        printf("// Layout: Left to Right (dx 0-15), Top to Bottom (dy 0-15)\n");
-        printf("const u8 aim_matrix[256] = {\n");
-        for (int dy = 0; dy < 16; dy++) {
-            printf("    ");
-            for (int dx = 0; dx < 16; dx++) {
-                printf("%2d,", targeting16x16[dx+16*dy]);
-            }
-            printf("\n");
-        }
-        printf("};\n\n"); 
-
-        
-
-        // Print the linear PATHS
-        printf("const   i8  PathAngleLUT[PATH_ANGLES][PATH_STEPS][2] ={\n\n");
-        for(int i=0;i<PATH_ANGLES;i++){
-            printf("    { ");
-            printf("// Angle: %d\n", (360*i)/128);
-            for(int j=0;j<PATH_STEPS;j++){
-                printf("{ %d, %d}", path_angle_lut[i][j][0], path_angle_lut[i][j][1]);
-                if(j!=PATH_STEPS-1)
-                    printf(", ");
+        printf("#define PATH_STEPS  %d\n#define PATH_ANGLES %d\n\n", PATH_STEPS, PATH_ANGLES);
+        if(options.layout!=LAYOUT_NONE){
+            layout_report(options.page_base);
+            layout_print(options.layout, options.page_base);
+            if(options.steppers){
+                stepper_print();
+                if(!stepper_finish(options.out, options.page_base))
+                    return 1;
             }
-            if(i!=PATH_ANGLES-1)
-                printf("},\n");
-            else
-                printf("}\n");
-        }
-        printf("};\n\n");
-        printf("const   u8  DegreeToPathAngleLUT[360] ={\n");
-        for(int i=0;i<18;i++){
-            printf("    ");
-            for(int j=0;j<20;j++){
-                if(i==17 && j==19)
-                    printf("%3d", angle_to_lut[i*20+j]);
-                else
-                    printf("%3d, ", angle_to_lut[i*20+j]);
-            }
-            printf("\n");
-        }
-        printf("};\n\n");
-        printf("const i8 ShootingCircle[3][%d][2]={ \n", PATH_ANGLES);  
-        for(int r=0;r<3;r++){
-            printf("    { ");
-            for(int a=0;a<128;a++){   
-                printf("{ %d, %d}", shootingPoints[r][a][0], shootingPoints[r][a][1]);
-                if(a!=127)
-                    printf(", ");
-                else
-                    printf(" ");
-                    
-            }
-            if(r!=2)
-                printf("},\n");
-            else
-                printf("}\n");
-        }
-        printf("};\n\n");
-
-        printf("const i8 SpiderPathDown[SPIDER_STEPS][2]={ \n\t");
-        for(int i=0;i<SPIDER_STEPS;++i){
-            if(path_spider[i]>=0)
-                printf("{0,%d}", path_spider[i]);
-
-            if(i!=SPIDER_STEPS-1)
-                printf(", ");
-            if(i%10==0 && i!= 0)
-                printf("\n\t");
-        }
-        printf("\n};\n");
-        printf("const i8 SpiderPathUp[SPIDER_STEPS][2]={ \n\t");
-        for(int i=0;i<SPIDER_STEPS;++i){
-            if(path_spider[i]>=0)
-                printf("{0,%d}", path_spider_up[i]);
-            if(i!=SPIDER_STEPS-1)
-                printf(", ");
-            if(i%10==0 && i!= 0)
-                printf("\n\t");
-        }
-        printf("\n};\n");
-
-        /*printf("const CirclePath     CirclePathLUT[MAX_CIRCLE_RADII]={\n");
-        for(int r=0;r<7;r++){
-            if(r!=6)
-                printf("    { CircleR%d, %d, %d},\n",(r+1)*16, (r+1)*16, path_circle_steps[r]);
-            else
-                printf("    { CircleR%d, %d, %d}\n",(r+1)*16, (r+1)*16, path_circle_steps[r]);
+            printf("#endif\n");
+            return 0;
         }
-        printf("};\n\n");
-        printf("#else\n\n");*/
-        printf("extern const u8 aim_matrix[256];\n");
-        printf("extern const i8 PathAngleLUT[PATH_ANGLES][PATH_STEPS][2];\n");
-        printf("extern const u8 DegreeToPathAngleLUT[360];\n");
-        printf("extern const u8 DegreeToPathAngleLUT[360];\n");
-        printf("extern const i8 ShootingCircle[3][PATH_ANGLES][2];\n");
-        printf("extern const i8 SpiderPathDown[SPIDER_STEPS][2];\n");
-        printf("extern const i8 SpiderPathUp[SPIDER_STEPS][2];\n");
-        //printf("extern const CirclePath CirclePathLUT[MAX_CIRCLE_RADII];\n\n");*/
+        if(options.aim_size)
+            aim_print(options.aim_size, options.aim_shift);
+        else
+            print_aim_matrix();
+        if(options.aim_log)
+            aim_log_print();
+        if(options.nbatch)
+            batch_print(options.batch, options.nbatch);
+        else if(options.nspeeds)
+            velocity_print(options.speeds, options.nspeeds);
+        else if(options.pack)
+            pack_print(options.fold);
+        else if(options.fold==FOLD_NONE)
+            print_path_angle_lut();
+        else
+            fold_print(options.fold);
+        if(options.aim_row)
+            aim_row_print(options.nspeeds>0);
+        if(options.hires)
+            hires_print(options.fold!=FOLD_NONE || options.pack);
+        print_degree_lut();
+        if(options.shooting)
+            shooting_print();
+        else
+            print_shooting_circle();
+        if(options.circles)
+            circle_print();
+        if(options.offsets)
+            offsets_print(options.fold);
+        if(options.patterns)
+            patterns_print();
+        if(options.steer)
+            steer_print();
+        if(options.lifetime)
+            lifetime_print();
+        if(options.spec && !spec_print_paths(options.spec))
+            return 1;
+        if(options.aim_size)
+            printf("extern %su8 aim_matrix[AIM_SIZE*AIM_SIZE];\n", emit_const("aim_matrix"));
+        else
+            printf("extern %su8 aim_matrix[256];\n", emit_const("aim_matrix"));
+        if(options.aim_log)
+            printf("extern %su8 AimLog[256];\nextern %su8 AimLogAngle[256];\n", emit_const("AimLog"), emit_const("AimLogAngle"));
+        if(options.nbatch)
+            batch_print_externs(options.batch, options.nbatch);
+        else if(options.nspeeds)
+            printf("extern %si16 PathVelocity[PATH_SPEEDS][PATH_ANGLES][2];\n", emit_const("PathVelocity"));
+        else if(options.pack)
+            printf("extern %su8 PathAnglePacked[PATH_PACKED_ROWS][PATH_STEPS/2];\n", emit_const("PathAnglePacked"));
+        else if(options.fold==FOLD_NONE)
+            printf("extern %si8 PathAngleLUT[PATH_ANGLES][PATH_STEPS][2];\n", emit_const("PathAngleLUT"));
+        else
+            printf("extern %si8 PathAngleFold[PATH_FOLD_ROWS][PATH_STEPS][2];\n", emit_const("PathAngleFold"));
+        if(options.aim_row)
+            printf("extern const AimRowPtr AimRowLUT[4][256];\n");
+        if(options.hires)
+            hires_print_externs();
+        printf("extern %su8 DegreeToPathAngleLUT[360];\n", emit_const("DegreeToPathAngleLUT"));
+        printf("extern %su8 DegreeToPathAngleLUT[360];\n", emit_const("DegreeToPathAngleLUT"));
+        if(options.shooting)
+            shooting_print_externs();
+        else
+            printf("extern %si8 ShootingCircle[3][PATH_ANGLES][2];\n", emit_const("ShootingCircle"));
+        if(options.spec)
+            spec_print_externs();
+        if(options.circles)
+            circle_print_externs();
+        if(options.offsets)
+            offsets_print_externs(options.fold);
+        if(options.patterns)
+            patterns_print_externs();
+        if(options.steer)
+            steer_print_externs();
+        if(options.lifetime)
+            lifetime_print_externs();
+        if(!emit_finish())
+            return 1;
         printf("#endif\n");
     }
+    return 0;
 }
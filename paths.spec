@@ -0,0 +1,16 @@
+# Example path spec, ./paths --spec=paths.spec > shmup_lut.h
+# kind      name        parameters (angles are PathAngleLUT indices, 32 is straight down)
+
+line        Dive        angle=32 speed=2 steps=16
+line        DiveSlow    angle=32 speed=1 steps=32
+arc         LoopRight   radius=24 start=64 sweep=128 speed=2
+mirror      LoopLeft    of=LoopRight axis=x
+sine        Weave       angle=32 speed=1 amplitude=16 period=48 steps=96
+# the spider paths, the SpiderPathDown/SpiderPathUp deltas of old, as streams read with SpecStep(): y from -31
+# to 55 on a sine, 3 degrees a step, truncated as the C of the old tables did
+ease        SpiderDrop  dx=0 dy=86 curve=out-sine steps=30 origin=0,-31 t=begin round=trunc store=auto
+ease        SpiderRise  dx=0 dy=86 curve=out-sine steps=30 origin=0,-31 backwards=yes round=trunc store=auto
+ease        Bounce      dx=0 dy=64 curve=out-bounce steps=48 store=auto
+bezier      SwoopRight  p1=80,0 p2=80,100 p3=0,100 speed=2 curve=in-out-quad
+mirror      SwoopLeft   of=SwoopRight axis=x
+sequence    DiveAndLoop of=Dive,LoopRight,Dive
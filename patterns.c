@@ -0,0 +1,185 @@
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include "generator.h"
+
+/*
+
+Bullet patterns, spawned by walking a table instead of adding angle offsets and reading ShootingCircle per bullet.
+Every pattern has the angle of each bullet and its spawn offset for the three ShootingCircle radii, or the
+--shooting ones:
+
+    spreadN:S   N bullets S angles apart, centered on the aim. Aimed: the angles are relative to the aim
+    ringN       N bullets around the circle, N a divisor of 128
+    spiralN:R   a ring of N bullets turning R angles per frame. One row per frame until it repeats
+
+Rings and spirals don't depend on the aim, so their angles and offsets are final. A spread does, and a table
+per aim angle would be 128 times bigger, so PatternAim() adds the aim and reads ShootingCircle (ShootingSpawn()
+with --shooting) for it. A spread only stores its angles, its spawn is 0.
+
+*/
+
+#define PATTERN_MAX     32
+#define PATTERN_DEFAULT "spread3:4,spread5:4,spread7:2,ring8,ring16,ring32,spiral8:2"
+
+enum PATTERN_KINDS {PATTERN_SPREAD, PATTERN_RING, PATTERN_SPIRAL};
+
+typedef struct Pattern{
+    int     kind, count, spacing, frames;
+    char    name[32];
+}Pattern;
+
+static Pattern patterns[PATTERN_MAX];
+static int npatterns;
+static const char *pattern_kinds[]={"spread", "ring", "spiral"};
+
+// Angle of bullet i in frame f, relative to the aim for spreads
+static int pattern_angle(const Pattern *p, int frame, int i){
+    if(p->kind==PATTERN_SPREAD)
+        return ((2*i-(p->count-1))*p->spacing/2)&(PATH_ANGLES-1);
+    return (i*PATH_ANGLES/p->count+frame*p->spacing)&(PATH_ANGLES-1);
+}
+
+static int pattern_gcd(int a, int b){
+    return b ? pattern_gcd(b, a%b) : a;
+}
+
+// Reads --patterns, an empty list for the default set. Returns false with a message on stderr if a pattern is wrong
+bool patterns_build(const char *list){
+    int bytes=0;
+
+    if(!*list)
+        list=PATTERN_DEFAULT;
+    npatterns=0;
+    while(*list){
+        Pattern *p=&patterns[npatterns];
+        size_t length=strcspn(list, ",");
+        char *end;
+        if(npatterns==PATTERN_MAX){
+            fprintf(stderr, "patterns: more than %d patterns\n", PATTERN_MAX);
+            return false;
+        }
+        p->kind=-1;
+        for(int k=0;k<3;k++)
+            if(!strncmp(list, pattern_kinds[k], strlen(pattern_kinds[k])))
+                p->kind=k;
+        if(p->kind<0){
+            fprintf(stderr, "patterns: unknown pattern %.*s, it must be spreadN:S, ringN or spiralN:R\n", (int)length, list);
+            return false;
+        }
+        p->count=strtol(list+strlen(pattern_kinds[p->kind]), &end, 10);
+        p->spacing=0;
+        if(p->kind!=PATTERN_RING && *end==':')
+            p->spacing=strtol(end+1, &end, 10);
+        if(end!=list+length || p->count<1 || p->count>PATH_ANGLES || (p->kind!=PATTERN_RING && (p->spacing<1 || p->spacing>=PATH_ANGLES))){
+            fprintf(stderr, "patterns: %.*s is wrong, it must be spreadN:S, ringN or spiralN:R\n", (int)length, list);
+            return false;
+        }
+        if(p->kind!=PATTERN_SPREAD && PATH_ANGLES%p->count){
+            fprintf(stderr, "patterns: %.*s, a ring must have a divisor of %d bullets\n", (int)length, list, PATH_ANGLES);
+            return false;
+        }
+        if(p->kind==PATTERN_SPREAD && (p->count-1)*p->spacing%2){
+            fprintf(stderr, "patterns: %.*s, an even spread needs an even spacing to stay centered on the aim\n", (int)length, list);
+            return false;
+        }
+        if(p->kind==PATTERN_SPREAD && (p->count-1)*p->spacing>=PATH_ANGLES){
+            fprintf(stderr, "patterns: %.*s, the spread goes round the circle\n", (int)length, list);
+            return false;
+        }
+        // a spiral repeats when it turned one bullet apart
+        p->frames=p->kind==PATTERN_SPIRAL ? PATH_ANGLES/p->count/pattern_gcd(PATH_ANGLES/p->count, p->spacing) : 1;
+        if(p->kind==PATTERN_RING)
+            snprintf(p->name, sizeof(p->name), "Ring%d", p->count);
+        else
+            snprintf(p->name, sizeof(p->name), "%s%d_%d", p->kind==PATTERN_SPREAD ? "Spread" : "Spiral", p->count, p->spacing);
+        for(int i=0;i<npatterns;i++)
+            if(!strcmp(patterns[i].name, p->name)){
+                fprintf(stderr, "patterns: %s is there twice\n", p->name);
+                return false;
+            }
+        bytes+=p->frames*p->count*(1+(p->kind==PATTERN_SPREAD ? 0 : shooting_count()*2));
+        npatterns++;
+        list+=length+(list[length]==',');
+    }
+    fprintf(stderr, "patterns: %d patterns, %d bytes of angles and spawn offsets\n", npatterns, bytes);
+    return true;
+}
+
+void patterns_print(void){
+    const char *type=options.shooting ? "u8" : "i8", *radii=options.shooting ? "MAX_SHOOTING_RADII" : "3";
+    int nradii=shooting_count();
+    char name[48], dims[48];
+
+    printf("enum   PATTERNS {");
+    for(int i=0;i<npatterns;i++){
+        char upper[32];
+        for(int c=0;(upper[c]=toupper(patterns[i].name[c]));c++);
+        printf("PATTERN_%s, ", upper);
+    }
+    printf("MAX_PATTERNS};\n\n");
+    printf("// angle[frame*count+i] and spawn[frame*count+i][radius] of bullet i, frames > 1 for spirals. Aimed\n");
+    printf("// patterns have angles relative to the aim and spawn 0, read them with PatternAim()\n");
+    printf("typedef struct BulletPattern{\n");
+    printf("    const u8  *angle;\n");
+    printf("    const %s  (*spawn)[%s][2];\n", type, radii);
+    printf("    u8  count;\n");
+    printf("    u8  frames;\n");
+    printf("    u8  aimed;\n");
+    printf("}BulletPattern;\n\n");
+    for(int i=0;i<npatterns;i++){
+        const Pattern *p=&patterns[i];
+        int n=p->frames*p->count, *angles=malloc(n*sizeof(int)), *spawn=malloc(n*nradii*2*sizeof(int));
+        int shape[3]={n, nradii, 2};
+        for(int f=0;f<p->frames;f++)
+            for(int b=0;b<p->count;b++){
+                int a=pattern_angle(p, f, b);
+                angles[f*p->count+b]=a;
+                for(int r=0;r<nradii;r++){
+                    spawn[((f*p->count+b)*nradii+r)*2]=shooting_point(r, a, 0);
+                    spawn[((f*p->count+b)*nradii+r)*2+1]=shooting_point(r, a, 1);
+                }
+            }
+        if(p->kind==PATTERN_SPREAD)
+            printf("// %d bullets %d angles apart, centered on the aim\n", p->count, p->spacing);
+        else if(p->kind==PATTERN_RING)
+            printf("// %d bullets around the circle\n", p->count);
+        else
+            printf("// %d bullets around the circle turning %d angles per frame, %d frames\n", p->count, p->spacing, p->frames);
+        snprintf(name, sizeof(name), "Pattern%sAngle", p->name);
+        snprintf(dims, sizeof(dims), "[%d]", n);
+        emit_table("u8", name, dims, angles, shape, 1);
+        if(p->kind!=PATTERN_SPREAD){
+            snprintf(name, sizeof(name), "Pattern%sSpawn", p->name);
+            snprintf(dims, sizeof(dims), "[%d][%s][2]", n, radii);
+            emit_table(type, name, dims, spawn, shape, 3);
+        }
+        free(angles);
+        free(spawn);
+    }
+    printf("const BulletPattern  PatternLUT[MAX_PATTERNS]={\n");
+    for(int i=0;i<npatterns;i++){
+        if(patterns[i].kind==PATTERN_SPREAD)
+            snprintf(name, sizeof(name), "0");     // no stddef.h in the header
+        else
+            snprintf(name, sizeof(name), "Pattern%sSpawn", patterns[i].name);
+        printf("    { Pattern%sAngle, %s, %d, %d, %d}%s\n", patterns[i].name, name, patterns[i].count, patterns[i].frames,
+            patterns[i].kind==PATTERN_SPREAD, i!=npatterns-1 ? "," : "");
+    }
+    printf("};\n\n");
+    printf("// Angle and spawn offset of bullet i of an aimed pattern, for a shot aimed at aim\n");
+    printf("static void PatternAim(const BulletPattern *p, u8 i, u8 aim, u8 radius, u8 *angle, %s *x, %s *y){\n", type, type);
+    printf("    u8 a = (p->angle[i] + aim) & %d;\n", PATH_ANGLES-1);
+    printf("    *angle = a;\n");
+    if(options.shooting)
+        printf("    ShootingSpawn(radius, a, x, y);\n");
+    else{
+        printf("    *x = ShootingCircle[radius][a][0];\n");
+        printf("    *y = ShootingCircle[radius][a][1];\n");
+    }
+    printf("}\n\n");
+}
+
+void patterns_print_externs(void){
+    printf("extern const BulletPattern PatternLUT[MAX_PATTERNS];\n");
+}
@@ -0,0 +1,338 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "generator.h"
+#include "z80.h"
+
+/*
+
+Replays a spawn trace frame by frame with a reference engine and adds up what every frame costs on the Z80 model,
+for each table mode. Averages hide the frames that drop: a boss ring while 30 aimed shots are in flight. So the
+report gives the cost of a frame as p50/p99/max and counts the frames over the budget.
+
+The engine, every frame:
+
+    steps every live bullet, one step per frame: one call per bullet of PathStep and the other steppers of --bench
+        (PathAngleFold, soa, soa-page, the --pack=nibble nibbles, the --offsets=16 PathOffset, PathVelocity), or
+        one PathStepBatch call of --steppers per 255 bullets for every layout
+    drops the bullets that left the 256x192 screen
+    runs the events of the frame: an aimed shot is one aim and a spawn per bullet, a ring or a shot only spawns
+
+A step, spawn or aim costs what the routine of --bench takes on the model for that input (steps and spawns as
+measured when they were checked, aims run again with the real positions), with the MSX M1 wait states. A batch
+costs what PathStepBatch takes for that many bullets, 4x unrolled (the --steppers default) with the tables from
+--page-base. Spawns go through SpawnBullet and ShootingCircle, or the ShootingSpawn of --shooting in its own mode.
+The bullets follow PathAngleLUT and the aim_matrix angle in every mode, so all modes replay the same bullets.
+
+The trace is a text file, one event per line, frames in order, # starts a comment:
+
+    FRAME player X Y            the player moves to (X, Y)
+    FRAME aim X Y [N S]         an enemy at (X, Y) fires N bullets S angles apart at the player (1 bullet)
+    FRAME ring X Y N [FIRST]    N bullets around, the first one at angle FIRST (0)
+    FRAME shot X Y ANGLE        one bullet
+
+Without a file it replays a built-in 3 minutes script: waves of enemies firing aimed shots and spreads, and two
+boss fights with rings, spirals and spreads on top of them.
+
+*/
+
+#define REPLAY_LINE     256
+#define REPLAY_MINUTES  3
+#define REPLAY_TAIL     600         // frames after the last event, for the bullets in flight
+#define REPLAY_WORST    8
+#define REPLAY_UNROLL   4
+#define REPLAY_BATCH    255         // bullets of a PathStepBatch call
+
+enum REPLAY_KINDS {REPLAY_PLAYER, REPLAY_AIM, REPLAY_RING, REPLAY_SHOT};
+
+typedef struct ReplayEvent{
+    int frame, kind, x, y, count, angle;    // angle: the spacing of aim, the first angle of ring and shot
+}ReplayEvent;
+
+typedef struct ReplayBullet{
+    int x, y, angle, step;
+}ReplayBullet;
+
+// A stepper, an aim and a spawn routine of bench.c, and the cost of every frame with them. With a batch layout the
+// bullets are moved by the PathStepBatch of stepper.c instead of the stepper
+typedef struct ReplayMode{
+    int     stepper, batch, aim, spawn;
+    long    *cost;
+    int     *reads;
+}ReplayMode;
+
+static const char *replay_kinds[]={"player", "aim", "ring", "shot"};
+static ReplayEvent *events;
+static int nevents, maxevents;
+static uint32_t replay_seed=12345;
+
+static void replay_add(int frame, int kind, int x, int y, int count, int angle){
+    if(nevents==maxevents){
+        maxevents=maxevents ? maxevents*2 : 1024;
+        events=realloc(events, maxevents*sizeof(*events));
+    }
+    events[nevents++]=(ReplayEvent){frame, kind, x, y, count, angle};
+}
+
+// Same numbers on every host
+static int replay_random(int n){
+    replay_seed=replay_seed*1103515245+12345;
+    return (replay_seed>>16)%n;
+}
+
+// The built-in script: 3 minutes at 60 Hz, a boss fight in the second and the third one
+static void replay_script(void){
+    int frames=REPLAY_MINUTES*60*60, enemies[8][3];
+
+    for(int f=0;f<frames;f++){
+        bool boss=f%3600>=1800;
+        if(f%8==0)
+            replay_add(f, REPLAY_PLAYER, 128+lround(100*sin(f/97.0)), 160+lround(16*sin(f/53.0)), 0, 0);
+        // a new wave every 10 seconds: 4 to 8 enemies, each with its own fire rate
+        if(f%600==0)
+            for(int e=0;e<8;e++){
+                enemies[e][0]=e<4+replay_random(5) ? 24+replay_random(208) : -1;
+                enemies[e][1]=24+replay_random(60);
+                enemies[e][2]=30+replay_random(60);
+            }
+        for(int e=0;e<8;e++){
+            int x=enemies[e][0], y=enemies[e][1]+(f%600)/20, rate=enemies[e][2];
+            if(x<0 || (f+e*7)%rate)
+                continue;
+            if(e%3==0)
+                replay_add(f, REPLAY_AIM, x, y, 3, 4);
+            else
+                replay_add(f, REPLAY_AIM, x, y, 1, 0);
+        }
+        if(!boss)
+            continue;
+        if(f%45==0)
+            replay_add(f, REPLAY_RING, 128, 40, 32, f/45%4);
+        if(f%4==0)
+            replay_add(f, REPLAY_RING, 128, 40, 4, (f/4*3)&(PATH_ANGLES-1));
+        if(f%60==30)
+            replay_add(f, REPLAY_AIM, 128, 48, 5, 4);
+    }
+}
+
+static bool replay_error(const char *file, int line, const char *message){
+    fprintf(stderr, "%s:%d: %s\n", file, line, message);
+    return false;
+}
+
+// Reads a trace file, - for stdin
+static bool replay_read(const char *file){
+    FILE *f=strcmp(file, "-") ? fopen(file, "r") : stdin;
+    char text[REPLAY_LINE];
+    int line=0, last=0;
+
+    if(!f){
+        fprintf(stderr, "%s: can't open\n", file);
+        return false;
+    }
+    while(fgets(text, sizeof(text), f)){
+        char *hash=strchr(text, '#'), kind[16];
+        int frame, x, y, a=-1, b=-1, k, n;
+        line++;
+        if(hash)
+            *hash=0;
+        n=sscanf(text, "%d %15s %d %d %d %d", &frame, kind, &x, &y, &a, &b);
+        if(n<=0)
+            continue;
+        for(k=0;k<4 && strcmp(kind, replay_kinds[k]);k++);
+        if(n<4 || k==4)
+            return replay_error(file, line, "expected FRAME player|aim|ring|shot X Y ...");
+        if(frame<last)
+            return replay_error(file, line, "the frames must be in order");
+        if(x<0 || x>255 || y<0 || y>255)
+            return replay_error(file, line, "X and Y must be 0 to 255");
+        if(k==REPLAY_AIM && n==5)
+            return replay_error(file, line, "an aimed spread needs N and S");
+        if((k==REPLAY_RING && n<5) || (k==REPLAY_SHOT && n!=5))
+            return replay_error(file, line, k==REPLAY_RING ? "a ring needs N" : "a shot needs ANGLE");
+        if(k==REPLAY_SHOT)
+            b=a, a=1;
+        if((k!=REPLAY_PLAYER && n>=5 && (a<1 || a>PATH_ANGLES)) || (b!=-1 && (b<0 || b>=PATH_ANGLES)))
+            return replay_error(file, line, "N must be 1 to 128 bullets, angles 0 to 127");
+        replay_add(frame, k, x, y, a<0 ? 1 : a, b<0 ? 0 : b);
+        last=frame;
+    }
+    if(f!=stdin)
+        fclose(f);
+    return true;
+}
+
+static void replay_call(ReplayMode *mode, int frame, BenchCall c){
+    mode->cost[frame]+=c.msx;
+    mode->reads[frame]+=c.reads;
+}
+
+static int replay_compare(const void *a, const void *b){
+    long x=*(const long *)a, y=*(const long *)b;
+
+    return (x>y)-(x<y);
+}
+
+static int replay_compare_int(const void *a, const void *b){
+    return *(const int *)a-*(const int *)b;
+}
+
+// p of frames, sorted
+static long replay_percentile(const long *sorted, int frames, int p){
+    return sorted[(long)(frames-1)*p/100];
+}
+
+// Replays the trace, an empty name for the built-in script, and prints the report instead of the header. share
+// is the percent of the frame the bullets may take. False if a routine is wrong or the trace can't be read
+bool replay_report(const char *file, int share){
+    int steppers=bench_count(BENCH_KIND_STEP), aims=bench_count(BENCH_KIND_AIM), spawns=bench_count(BENCH_KIND_SPAWN);
+    int nmodes=steppers+LAYOUT_SOA_PAGE+aims-1+spawns-1, frames, alive=0, most=0, most_frame=0;
+    int px=128, py=160, next=0, nbullets=0, maxbullets=256, *alive_at, *spawns_at, worst[REPLAY_WORST];
+    long spawned=0, aimed=0, budget60=(long)Z80_FRAME_60HZ*share/100, budget50=(long)Z80_FRAME_50HZ*share/100;
+    ReplayBullet *bullets;
+    ReplayMode *modes;
+
+    if(!*file)
+        replay_script();
+    else if(!replay_read(file))
+        return false;
+    if(!nevents){
+        fprintf(stderr, "replay: %s has no events\n", file);
+        return false;
+    }
+    if(!bench_open() || !stepper_open(options.page_base, REPLAY_UNROLL)){
+        bench_close();
+        return false;
+    }
+    frames=events[nevents-1].frame+1+REPLAY_TAIL;
+    bullets=malloc(maxbullets*sizeof(*bullets));
+    modes=calloc(nmodes, sizeof(*modes));
+    alive_at=calloc(frames, sizeof(int));
+    spawns_at=calloc(frames, sizeof(int));
+    // every stepper and every batch layout with AimShot, then the other aims and spawns with PathStep
+    for(int m=0;m<nmodes;m++){
+        if(m<steppers)
+            modes[m].stepper=m;
+        else if(m<steppers+LAYOUT_SOA_PAGE)
+            modes[m].batch=m-steppers+1;
+        else if(m<steppers+LAYOUT_SOA_PAGE+aims-1)
+            modes[m].aim=m-steppers-LAYOUT_SOA_PAGE+1;
+        else
+            modes[m].spawn=m-steppers-LAYOUT_SOA_PAGE-aims+2;
+        modes[m].cost=calloc(frames, sizeof(long));
+        modes[m].reads=calloc(frames, sizeof(int));
+    }
+    for(int f=0;f<frames;f++){
+        alive=0;
+        for(int m=0;m<nmodes;m++)
+            for(int i=0;modes[m].batch && i<(nbullets ? (nbullets+REPLAY_BATCH-1)/REPLAY_BATCH : 1);i++){
+                int count=nbullets-i*REPLAY_BATCH;
+                replay_call(&modes[m], f, stepper_call(modes[m].batch, count<REPLAY_BATCH ? count : REPLAY_BATCH));
+            }
+        for(int i=0;i<nbullets;i++){
+            ReplayBullet *b=&bullets[i];
+            for(int m=0;m<nmodes;m++)
+                if(!modes[m].batch)
+                    replay_call(&modes[m], f, bench_step_call(modes[m].stepper, b->angle, b->step));
+            b->x+=path_angle_lut[b->angle][b->step][0];
+            b->y+=path_angle_lut[b->angle][b->step][1];
+            b->step=(b->step+1)&(PATH_STEPS-1);
+            if(b->x>=0 && b->x<256 && b->y>=0 && b->y<192)
+                bullets[alive++]=*b;
+        }
+        nbullets=alive;
+        for(;next<nevents && events[next].frame==f;next++){
+            const ReplayEvent *e=&events[next];
+            int first=e->angle;
+            if(e->kind==REPLAY_PLAYER){
+                px=e->x;
+                py=e->y;
+                continue;
+            }
+            if(e->kind==REPLAY_AIM){
+                int aim=aim_angle(targeting16x16, 16, 4, px-e->x, py-e->y, NULL);
+                for(int m=0;m<nmodes;m++)
+                    replay_call(&modes[m], f, bench_aim_call(modes[m].aim, e->x, e->y, px, py));
+                first=aim-(e->count-1)*e->angle/2;
+                aimed++;
+            }
+            for(int i=0;i<e->count;i++){
+                int a=e->kind==REPLAY_AIM ? first+i*e->angle : first+i*PATH_ANGLES/e->count;
+                a&=PATH_ANGLES-1;
+                for(int m=0;m<nmodes;m++)
+                    replay_call(&modes[m], f, bench_spawn_call(modes[m].spawn, 0, a));
+                if(nbullets==maxbullets){
+                    maxbullets*=2;
+                    bullets=realloc(bullets, maxbullets*sizeof(*bullets));
+                }
+                bullets[nbullets++]=(ReplayBullet){e->x+shootingPoints[0][a][0], e->y+shootingPoints[0][a][1], a, 0};
+                spawns_at[f]++;
+                spawned++;
+            }
+        }
+        alive_at[f]=nbullets;
+        if(nbullets>most){
+            most=nbullets;
+            most_frame=f;
+        }
+    }
+
+    printf("Replay of %s: %d frames (%d:%02d at 60 Hz), %ld bullets spawned, %ld aimed shots, up to %d bullets alive (frame %d)\n",
+        *file ? file : "the built-in script", frames, frames/3600, frames/60%60, spawned, aimed, most, most_frame);
+    printf("MSX T-states per frame for the bullets (steps, aims and spawns), %d%% of the frame: %ld at 60 Hz, %ld at 50 Hz\n\n",
+        share, budget60, budget50);
+    printf("%-36s %-23s   %-17s   %s\n", "", "T-states", "table reads", "frames over");
+    printf("%-36s %7s %7s %7s   %5s %5s %5s   %6s %6s\n", "stepper + aim [+ spawn]", "p50", "p99", "max", "p50", "p99", "max",
+        "60 Hz", "50 Hz");
+    for(int m=0;m<nmodes;m++){
+        long *sorted=malloc(frames*sizeof(long)), over60=0, over50=0;
+        int *reads=malloc(frames*sizeof(int));
+        char name[80];
+        memcpy(sorted, modes[m].cost, frames*sizeof(long));
+        memcpy(reads, modes[m].reads, frames*sizeof(int));
+        qsort(sorted, frames, sizeof(long), replay_compare);
+        qsort(reads, frames, sizeof(int), replay_compare_int);
+        for(int f=0;f<frames;f++){
+            over60+=modes[m].cost[f]>budget60;
+            over50+=modes[m].cost[f]>budget50;
+        }
+        snprintf(name, sizeof(name), "%s%s + %s%s%s", modes[m].batch ? "PathStepBatch/" : "",
+            modes[m].batch ? stepper_name(modes[m].batch) : bench_name(BENCH_KIND_STEP, modes[m].stepper),
+            bench_name(BENCH_KIND_AIM, modes[m].aim), modes[m].spawn ? " + " : "",
+            modes[m].spawn ? bench_name(BENCH_KIND_SPAWN, modes[m].spawn) : "");
+        printf("%-36s %7ld %7ld %7ld   %5d %5d %5d   %6ld %6ld\n", name, replay_percentile(sorted, frames, 50),
+            replay_percentile(sorted, frames, 99), sorted[frames-1], reads[(frames-1)/2], reads[(long)(frames-1)*99/100],
+            reads[frames-1], over60, over50);
+        free(sorted);
+        free(reads);
+    }
+
+    // the worst frames of the first mode, the one the engine uses today
+    printf("\nWorst frames with %s + %s:\n\n", bench_name(BENCH_KIND_STEP, 0), bench_name(BENCH_KIND_AIM, 0));
+    printf("%7s %7s %7s %7s %8s\n", "frame", "time", "alive", "spawns", "T-states");
+    for(int i=0;i<REPLAY_WORST && i<frames;i++){
+        long *cost=modes[0].cost;
+        int w=-1;
+        for(int f=0;f<frames;f++){
+            bool taken=false;
+            for(int j=0;j<i;j++)
+                taken=taken || worst[j]==f;
+            if(!taken && (w<0 || cost[f]>cost[w]))
+                w=f;
+        }
+        worst[i]=w;
+        printf("%7d %4d:%02d %7d %7d %8ld%s\n", w, w/3600, w/60%60, alive_at[w], spawns_at[w], cost[w],
+            cost[w]>budget60 ? "   over 60 Hz" : "");
+    }
+    for(int m=0;m<nmodes;m++){
+        free(modes[m].cost);
+        free(modes[m].reads);
+    }
+    free(modes);
+    free(bullets);
+    free(alive_at);
+    free(spawns_at);
+    free(events);
+    bench_close();
+    return true;
+}
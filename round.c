@@ -0,0 +1,324 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "generator.h"
+
+/*
+
+PathAngleLUT rows are the lround of the positions along the line, but any position within B pixels of the line
+would do, and some choices compress much better: a row with long runs of the same delta, or the same deltas as
+its neighbour, or a row that is already in the table. --round=B searches the rows of the first octant for the
+smallest ZX0 stream, then the fewest distinct rows, then the fewest runs of equal deltas, keeping every position
+of every row within B pixels of the true line:
+
+    |P(k) - line(k)| <= B       on both axes, k = 1 to PATH_STEPS
+
+and the rest of the rules of the table, so --fold, --pack and the drift of repeated rows don't change:
+
+    the deltas of the first quadrant are 0 to 3 (a bullet never goes back, and --pack fits 2 bits)
+    the last position of a row is the lround one, so a row repeated forever drifts the same (--round-free lets
+    it end anywhere within B, which lets neighbour angles share a row at 1 pixel and more)
+    angle 16 has dx = dy, so it is its own mirror for --fold=octant
+
+The other 111 rows are the octant swapped and rotated, as --fold rebuilds them. Each octant row has a few
+candidates per axis, from a DP over the positions allowed at every step: the fewest changes of delta, the
+deltas closest to the rows of the previous and next angles, and lround. Every pair of them, and every row
+already in the octant that fits the bound, is tried in turn and the best octant is kept, until a pass changes
+nothing. The report compares the result with lround.
+
+*/
+
+#define ROUND_WINDOW    4       // positions allowed at a step, 2*B+1 at most
+#define ROUND_DELTA     4       // deltas 0 to 3
+#define ROUND_ROWS      (ANGLES_PER_QUADRANT/2+1)
+#define ROUND_PASSES    4
+#define ROUND_NONE      1000000
+
+static double round_bound;
+static bool round_free;
+static int round_rows[ROUND_ROWS][PATH_STEPS][2];
+
+// Distance along axis of the line of octant angle a after k steps
+static double round_line(int a, int axis, int k){
+    double radians=a*2*M_PI/PATH_ANGLES;
+
+    return (axis ? sin(radians) : cos(radians))*DISTANCE*k;
+}
+
+// Lowest position allowed at step k
+static int round_low(int a, int axis, int k){
+    return k==PATH_STEPS && !round_free ? lround(round_line(a, axis, k)) : (int)ceil(round_line(a, axis, k)-round_bound-1e-9);
+}
+
+static int round_high(int a, int axis, int k){
+    return k==PATH_STEPS && !round_free ? lround(round_line(a, axis, k)) : (int)floor(round_line(a, axis, k)+round_bound+1e-9);
+}
+
+// Deltas of axis that change the least from one step to the next, or that differ the least from target when it
+// isn't NULL, the ones closest to the line among those. False if no positions fit
+static bool round_dp(int a, int axis, const int *target, int *deltas){
+    static double cost[PATH_STEPS+1][ROUND_WINDOW][ROUND_DELTA];
+    static int from[PATH_STEPS+1][ROUND_WINDOW][ROUND_DELTA];
+    double best=ROUND_NONE;
+    int p=-1, d=-1;
+
+    for(int k=0;k<=PATH_STEPS;k++)
+        for(int i=0;i<ROUND_WINDOW;i++)
+            for(int j=0;j<ROUND_DELTA;j++)
+                cost[k][i][j]=ROUND_NONE;
+    cost[0][0][0]=0;
+    for(int k=1;k<=PATH_STEPS;k++){
+        int low=round_low(a, axis, k), high=round_high(a, axis, k), before=k==1 ? 0 : round_low(a, axis, k-1);
+        int last=k==1 ? 0 : round_high(a, axis, k-1);
+        for(int pos=low;pos<=high && pos-low<ROUND_WINDOW;pos++)
+            for(int q=before;q<=last && q-before<ROUND_WINDOW;q++){
+                int delta=pos-q;
+                if(delta<0 || delta>=ROUND_DELTA)
+                    continue;
+                for(int previous=0;previous<ROUND_DELTA;previous++){
+                    double c=cost[k-1][q-before][previous], change;
+                    if(c>=ROUND_NONE)
+                        continue;
+                    change=target ? delta!=target[k-1] : k>1 && delta!=previous;
+                    c+=change*PATH_STEPS+fabs(pos-round_line(a, axis, k))/PATH_STEPS;
+                    if(c<cost[k][pos-low][delta]){
+                        cost[k][pos-low][delta]=c;
+                        from[k][pos-low][delta]=previous;
+                    }
+                }
+            }
+    }
+    for(int i=0;i<ROUND_WINDOW;i++)
+        for(int j=0;j<ROUND_DELTA;j++)
+            if(cost[PATH_STEPS][i][j]<best){
+                best=cost[PATH_STEPS][i][j];
+                p=round_low(a, axis, PATH_STEPS)+i;
+                d=j;
+            }
+    if(d<0)
+        return false;
+    for(int k=PATH_STEPS;k>0;k--){
+        int previous=from[k][p-round_low(a, axis, k)][d];
+        deltas[k-1]=d;
+        p-=d;
+        d=previous;
+    }
+    return true;
+}
+
+// True if the deltas of axis keep octant angle a within the bound and the rules
+static bool round_fits(int a, int axis, const int *deltas){
+    int pos=0;
+
+    for(int k=1;k<=PATH_STEPS;k++){
+        if(deltas[k-1]<0 || deltas[k-1]>=ROUND_DELTA)
+            return false;
+        pos+=deltas[k-1];
+        if(pos<round_low(a, axis, k) || pos>round_high(a, axis, k))
+            return false;
+    }
+    return true;
+}
+
+// PathAngleLUT from the octant rows, the way --fold=octant rebuilds it
+static void round_expand(int (*rows)[PATH_STEPS][2], int (*lut)[PATH_STEPS][2]){
+    for(int i=0;i<PATH_ANGLES;i++){
+        int a=i%ANGLES_PER_QUADRANT;
+        for(int step=0;step<PATH_STEPS;step++){
+            int x, y;
+            if(a>ANGLES_PER_QUADRANT/2){
+                x=rows[ANGLES_PER_QUADRANT-a][step][1];
+                y=rows[ANGLES_PER_QUADRANT-a][step][0];
+            }
+            else{
+                x=rows[a][step][0];
+                y=rows[a][step][1];
+            }
+            fold_rotate(i, x, y, &lut[i][step][0], &lut[i][step][1]);
+        }
+    }
+}
+
+static int round_pack(const int *values, int count){
+    uint8_t *bytes=malloc(count), *packed=malloc(count+count/8+16);
+    int size;
+
+    for(int i=0;i<count;i++)
+        bytes[i]=values[i];
+    size=zx0_compress(bytes, count, packed);
+    free(bytes);
+    free(packed);
+    return size;
+}
+
+// What the search minimizes, in order, over the octant rows
+typedef struct RoundScore{
+    int     zx0, unique, runs;
+}RoundScore;
+
+static void round_score(RoundScore *s){
+    s->zx0=round_pack(&round_rows[0][0][0], ROUND_ROWS*PATH_STEPS*2);
+    s->unique=s->runs=0;
+    for(int a=0;a<ROUND_ROWS;a++){
+        int unique=1;
+        for(int step=0;step<PATH_STEPS;step++)
+            for(int axis=0;axis<2;axis++)
+                s->runs+=!step || round_rows[a][step][axis]!=round_rows[a][step-1][axis];
+        for(int j=0;j<a && unique;j++)
+            unique=memcmp(round_rows[a], round_rows[j], sizeof(round_rows[a]))!=0;
+        s->unique+=unique;
+    }
+}
+
+static bool round_better(const RoundScore *a, const RoundScore *b, bool ties){
+    if(a->zx0!=b->zx0 || !ties)
+        return a->zx0<b->zx0;
+    return a->unique!=b->unique ? a->unique<b->unique : a->runs<b->runs;
+}
+
+typedef struct RoundStats{
+    double  max, mean;
+    int     unique, runs, zx0_octant, zx0_table;
+}RoundStats;
+
+// Error against the true lines, distinct rows, runs of equal deltas and ZX0 sizes of a full table
+static void round_stats(int (*lut)[PATH_STEPS][2], RoundStats *s){
+    double total=0;
+
+    memset(s, 0, sizeof(*s));
+    for(int i=0;i<PATH_ANGLES;i++){
+        double radians=i*2*M_PI/PATH_ANGLES;
+        int x=0, y=0, unique=1;
+        for(int step=0;step<PATH_STEPS;step++){
+            double e;
+            x+=lut[i][step][0];
+            y+=lut[i][step][1];
+            e=fmax(fabs(x-cos(radians)*DISTANCE*(step+1)), fabs(y-sin(radians)*DISTANCE*(step+1)));
+            s->max=fmax(s->max, e);
+            total+=e;
+            for(int axis=0;axis<2;axis++)
+                s->runs+=!step || lut[i][step][axis]!=lut[i][step-1][axis];
+        }
+        for(int j=0;j<i && unique;j++)
+            unique=memcmp(lut[i], lut[j], sizeof(lut[i]))!=0;
+        s->unique+=unique;
+    }
+    s->mean=total/(PATH_ANGLES*PATH_STEPS);
+    s->zx0_octant=round_pack(&lut[0][0][0], ROUND_ROWS*PATH_STEPS*2);
+    s->zx0_table=round_pack(&lut[0][0][0], PATH_ANGLES*PATH_STEPS*2);
+}
+
+static void round_report_line(const char *name, const RoundStats *s){
+    fprintf(stderr, "round: %-10s %8.2f %8.3f %8d %8d %12d %12d\n", name, s->max, s->mean, s->unique, s->runs, s->zx0_octant,
+        s->zx0_table);
+}
+
+// True if both axes of row keep octant angle a within the bound and the rules
+static bool round_row_fits(int a, int (*row)[2]){
+    int axis[2][PATH_STEPS];
+
+    for(int k=0;k<PATH_STEPS;k++){
+        axis[0][k]=row[k][0];
+        axis[1][k]=row[k][1];
+        if(a==ANGLES_PER_QUADRANT/2 && row[k][0]!=row[k][1])
+            return false;
+    }
+    return round_fits(a, 0, axis[0]) && round_fits(a, 1, axis[1]);
+}
+
+// Candidates of an axis of octant angle a: lround, the fewest changes, the closest to the previous and next
+// angles. Returns how many, without repeats
+static int round_axis(int a, int axis, int (*list)[PATH_STEPS]){
+    int count=1;
+
+    for(int k=0;k<PATH_STEPS;k++)
+        list[0][k]=path_angle_lut[a][k][axis];
+    for(int c=0;c<3;c++){
+        int neighbour=c==1 ? a-1 : a+1, target[PATH_STEPS];
+        bool repeat=false;
+        if(c && (neighbour<0 || neighbour>=ROUND_ROWS))
+            continue;
+        for(int k=0;k<PATH_STEPS && c;k++)
+            target[k]=round_rows[neighbour][k][axis];
+        if(!round_dp(a, axis, c ? target : NULL, list[count]))
+            continue;
+        for(int i=0;i<count;i++)
+            repeat=repeat || !memcmp(list[i], list[count], sizeof(list[i]));
+        count+=!repeat;
+    }
+    return count;
+}
+
+// One pass over the octant rows, each replaced by its best candidate. Ties of ZX0 size only count with ties.
+// True if a row changed
+static bool round_pass(bool ties){
+    bool changed=false;
+
+    for(int a=0;a<ROUND_ROWS;a++){
+        int axes[2][4][PATH_STEPS], counts[2], pairs, current[PATH_STEPS][2];
+        RoundScore best;
+        bool mirror=a==ANGLES_PER_QUADRANT/2;
+        counts[0]=round_axis(a, 0, axes[0]);
+        counts[1]=round_axis(a, 1, axes[1]);
+        pairs=counts[0]*counts[1];
+        memcpy(current, round_rows[a], sizeof(current));
+        round_score(&best);
+        // every pair of axis candidates, then every row of the octant that fits
+        for(int c=0;c<pairs+ROUND_ROWS;c++){
+            int row[PATH_STEPS][2];
+            RoundScore score;
+            if(c<pairs)
+                for(int k=0;k<PATH_STEPS;k++){
+                    row[k][0]=axes[0][c/counts[1]][k];
+                    row[k][1]=mirror ? row[k][0] : axes[1][c%counts[1]][k];
+                }
+            else
+                memcpy(row, round_rows[c-pairs], sizeof(row));
+            if(!memcmp(row, current, sizeof(row)) || !round_row_fits(a, row))
+                continue;
+            memcpy(round_rows[a], row, sizeof(row));
+            round_score(&score);
+            if(round_better(&score, &best, ties)){
+                best=score;
+                memcpy(current, row, sizeof(current));
+                changed=true;
+            }
+        }
+        memcpy(round_rows[a], current, sizeof(current));
+    }
+    return changed;
+}
+
+// Replaces path_angle_lut with the rows that pack smallest within bound pixels of the lines, ending on the lround
+// position unless free, and reports what it gets against lround on stderr. False if the result breaks a rule,
+// which would be a bug
+bool round_build(double bound, bool free){
+    static int lut[PATH_ANGLES][PATH_STEPS][2];
+    RoundStats before, after;
+    int passes=0;
+
+    round_bound=bound;
+    round_free=free;
+    round_stats(path_angle_lut, &before);
+    for(int a=0;a<ROUND_ROWS;a++)
+        memcpy(round_rows[a], path_angle_lut[a], sizeof(round_rows[a]));
+    // the ZX0 size alone first, then the ties broken without growing it
+    for(int ties=0;ties<2;ties++){
+        bool changed=true;
+        for(int i=0;changed && i<ROUND_PASSES;i++, passes++)
+            changed=round_pass(ties);
+    }
+    round_expand(round_rows, lut);
+    round_stats(lut, &after);
+    if(after.max>bound+1e-9){
+        fprintf(stderr, "round: the rows are %.2f pixels off the line, more than %.2f\n", after.max, bound);
+        return false;
+    }
+    memcpy(path_angle_lut, lut, sizeof(lut));
+    fprintf(stderr, "round: rows within %.2f pixels of the line, %d passes, %s\n", bound, passes,
+        free ? "ending anywhere within it" : "same end point as lround for every row");
+    fprintf(stderr, "round: %-10s %8s %8s %8s %8s %12s %12s\n", "", "max", "mean", "unique", "runs", "zx0 octant", "zx0 table");
+    round_report_line("lround", &before);
+    round_report_line("optimized", &after);
+    return true;
+}
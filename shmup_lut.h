@@ -1,9 +1,8 @@
-                                                                #ifndef  PATHS_H
+#ifndef  PATHS_H
 #define PATHS_H
 
 #define PATH_STEPS  16
 #define PATH_ANGLES 128
-#define SPIDER_STEPS 30
 
 // 16x16 Aiming Matrix for 128-Angle System
 // Layout: Left to Right (dx 0-15), Top to Bottom (dy 0-15)
@@ -313,21 +312,9 @@ const i8 ShootingCircle[3][128][2]={
     { { 59, 30}, { 59, 31}, { 59, 33}, { 59, 34}, { 58, 36}, { 58, 37}, { 58, 38}, { 57, 40}, { 57, 41}, { 56, 42}, { 56, 44}, { 55, 45}, { 54, 46}, { 53, 47}, { 52, 48}, { 51, 49}, { 51, 51}, { 49, 51}, { 48, 52}, { 47, 53}, { 46, 54}, { 45, 55}, { 44, 56}, { 42, 56}, { 41, 57}, { 40, 57}, { 38, 58}, { 37, 58}, { 36, 58}, { 34, 59}, { 33, 59}, { 31, 59}, { 30, 59}, { 29, 59}, { 27, 59}, { 26, 59}, { 24, 58}, { 23, 58}, { 22, 58}, { 20, 57}, { 19, 57}, { 18, 56}, { 16, 56}, { 15, 55}, { 14, 54}, { 13, 53}, { 12, 52}, { 11, 51}, { 9, 51}, { 9, 49}, { 8, 48}, { 7, 47}, { 6, 46}, { 5, 45}, { 4, 44}, { 4, 42}, { 3, 41}, { 3, 40}, { 2, 38}, { 2, 37}, { 2, 36}, { 1, 34}, { 1, 33}, { 1, 31}, { 1, 30}, { 1, 29}, { 1, 27}, { 1, 26}, { 2, 24}, { 2, 23}, { 2, 22}, { 3, 20}, { 3, 19}, { 4, 18}, { 4, 16}, { 5, 15}, { 6, 14}, { 7, 13}, { 8, 12}, { 9, 11}, { 9, 9}, { 11, 9}, { 12, 8}, { 13, 7}, { 14, 6}, { 15, 5}, { 16, 4}, { 18, 4}, { 19, 3}, { 20, 3}, { 22, 2}, { 23, 2}, { 24, 2}, { 26, 1}, { 27, 1}, { 29, 1}, { 30, 1}, { 31, 1}, { 33, 1}, { 34, 1}, { 36, 2}, { 37, 2}, { 38, 2}, { 40, 3}, { 41, 3}, { 42, 4}, { 44, 4}, { 45, 5}, { 46, 6}, { 47, 7}, { 48, 8}, { 49, 9}, { 51, 9}, { 51, 11}, { 52, 12}, { 53, 13}, { 54, 14}, { 55, 15}, { 56, 16}, { 56, 18}, { 57, 19}, { 57, 20}, { 58, 22}, { 58, 23}, { 58, 24}, { 59, 26}, { 59, 27}, { 59, 29} }
 };
 
-const u8 SpiderPathDown[SPIDER_STEPS]={ 
-	{0,0}, {0,5}, {0,4}, {0,5}, {0,4}, {0,5}, {0,4}, {0,4}, {0,3}, {0,5}, {0,3}, 
-	{0,4}, {0,4}, {0,4}, {0,3}, {0,3}, {0,3}, {0,3}, {0,3}, {0,3}, {0,2}, 
-	{0,2}, {0,2}, {0,2}, {0,1}, {0,2}, {0,1}, {0,0}, {0,1}, {0,0}
-};
-const u8 SpiderPathUp[SPIDER_STEPS]={ 
-	{0,-1}, {0,0}, {0,-1}, {0,0}, {0,-1}, {0,-2}, {0,-1}, {0,-2}, {0,-2}, {0,-2}, {0,-2}, 
-	{0,-3}, {0,-3}, {0,-3}, {0,-3}, {0,-3}, {0,-3}, {0,-4}, {0,-4}, {0,-4}, {0,-3}, 
-	{0,-5}, {0,-3}, {0,-4}, {0,-4}, {0,-5}, {0,-4}, {0,-5}, {0,-4}, {0,-5}
-};
 extern const u8 aim_matrix[256];
 extern const i8 PathAngleLUT[PATH_ANGLES][PATH_STEPS][2];
 extern const u8 DegreeToPathAngleLUT[360];
 extern const u8 DegreeToPathAngleLUT[360];
 extern const i8 ShootingCircle[3][PATH_ANGLES][2];
-extern const i8 SpiderPathDown[SPIDER_STEPS][2];
-extern const i8 SpiderPathUp[SPIDER_STEPS][2];
 #endif
@@ -0,0 +1,183 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "generator.h"
+
+/*
+
+ShootingCircle folded to an octant, for any list of radii. A spawn point of radius R is the center of the sprite
+plus the offset of the angle on a circle of R-3 pixels:
+
+    x = (R-2) + round(cos(angle)*(R-3))
+    y = (R-2) + round(sin(angle)*(R-3))
+
+The full table is 128 angles by 2 bytes, 256 bytes per radius. The offsets of the other quadrants are the first
+quadrant ones with their signs changed, the same quadrant rules aim_matrix uses to turn its 0-32 angle into a full
+one, run backwards. Inside the first quadrant, angle 32-k is angle k with x and y swapped. So only angles 0 to 16
+are stored, as u8 distances from the center:
+
+    ShootingOctant[radius][k]   (|dx|, |dy|) of angle k, k = 0 to 16
+    ShootingCenter[radius]      R-2
+
+ShootingSpawn() rebuilds the point, 35 bytes per radius instead of 256. The radii are 4 to 128 pixels, the
+points stay inside 0-255 so they fit an u8 instead of the i8 of ShootingCircle.
+
+*/
+
+#define SHOOTING_MAX        16
+#define SHOOTING_DEFAULT    "8,16,32"
+#define SHOOTING_OCTANT     (ANGLES_PER_QUADRANT/2+1)
+
+static int shooting_radii[SHOOTING_MAX], nradii;
+static int shooting_octant[SHOOTING_MAX][SHOOTING_OCTANT][2];
+
+// Spawn point computed directly, the ShootingCircle formula
+static void shooting_direct(int radius, int angle, int *x, int *y){
+    double radians=angle*2*M_PI/PATH_ANGLES;
+
+    *x=radius+lround(cos(radians)*(radius-3))-2;
+    *y=radius+lround(sin(radians)*(radius-3))-2;
+}
+
+// Spawn point rebuilt from the octant, the way ShootingSpawn() does it
+static void shooting_rebuild(int r, int angle, int *x, int *y){
+    int quadrant, k, ox, oy, center=shooting_radii[r]-2;
+
+    angle&=PATH_ANGLES-1;
+    if(angle>96)
+        quadrant=2;         // dx >= 0, dy < 0
+    else if(angle>64)
+        quadrant=3;         // dx < 0, dy < 0
+    else if(angle>32)
+        quadrant=1;         // dx < 0, dy >= 0
+    else
+        quadrant=0;
+    // the quadrant rules are their own inverse, but for the 64 + angle of quadrant 3
+    k=quadrant==3 ? angle-64 : aim_quadrant(angle, quadrant)&(PATH_ANGLES-1);
+    if(k>ANGLES_PER_QUADRANT/2){
+        ox=shooting_octant[r][ANGLES_PER_QUADRANT-k][1];
+        oy=shooting_octant[r][ANGLES_PER_QUADRANT-k][0];
+    }
+    else{
+        ox=shooting_octant[r][k][0];
+        oy=shooting_octant[r][k][1];
+    }
+    *x=quadrant&1 ? center-ox : center+ox;
+    *y=quadrant&2 ? center-oy : center+oy;
+}
+
+// Reads --shooting, an empty list for the ShootingCircle radii, folds and checks them. False with a message on stderr
+bool shooting_build(const char *list){
+    int differ=0;
+
+    if(!*list)
+        list=SHOOTING_DEFAULT;
+    nradii=0;
+    while(*list){
+        size_t length=strcspn(list, ",");
+        char *end;
+        if(nradii==SHOOTING_MAX){
+            fprintf(stderr, "shooting: more than %d radii\n", SHOOTING_MAX);
+            return false;
+        }
+        shooting_radii[nradii]=strtol(list, &end, 10);
+        if(end!=list+length || shooting_radii[nradii]<4 || shooting_radii[nradii]>128){
+            fprintf(stderr, "shooting: %.*s is wrong, the radii must be 4 to 128 pixels\n", (int)length, list);
+            return false;
+        }
+        for(int i=0;i<nradii;i++)
+            if(shooting_radii[i]==shooting_radii[nradii]){
+                fprintf(stderr, "shooting: radius %d is there twice\n", shooting_radii[i]);
+                return false;
+            }
+        nradii++;
+        list+=length+(list[length]==',');
+    }
+    for(int r=0;r<nradii;r++){
+        int center=shooting_radii[r]-2, count=0;
+        for(int k=0;k<SHOOTING_OCTANT;k++){
+            int x, y;
+            shooting_direct(shooting_radii[r], k, &x, &y);
+            shooting_octant[r][k][0]=x-center;
+            shooting_octant[r][k][1]=y-center;
+        }
+        for(int a=0;a<PATH_ANGLES;a++){
+            int x, y, rx, ry;
+            shooting_direct(shooting_radii[r], a, &x, &y);
+            shooting_rebuild(r, a, &rx, &ry);
+            if(rx<0 || rx>255 || ry<0 || ry>255){
+                fprintf(stderr, "shooting: radius %d angle %d spawns at (%d, %d), outside an u8\n", shooting_radii[r], a, rx, ry);
+                return false;
+            }
+            if(abs(rx-x)>1 || abs(ry-y)>1){
+                fprintf(stderr, "shooting: radius %d angle %d is rebuilt at (%d, %d) instead of (%d, %d)\n", shooting_radii[r], a,
+                    rx, ry, x, y);
+                return false;
+            }
+            count+=rx!=x || ry!=y;
+        }
+        differ+=count;
+    }
+    fprintf(stderr, "shooting: %d radii, %d bytes instead of %d, %d points differ from the direct circles by a pixel\n", nradii,
+        nradii*(SHOOTING_OCTANT*2+1), nradii*PATH_ANGLES*2, differ);
+    return true;
+}
+
+// Radii of the spawn points, the 3 of ShootingCircle without --shooting
+int shooting_count(void){
+    return nradii ? nradii : 3;
+}
+
+// Spawn point of radius r along axis, the one the header rebuilds
+int shooting_point(int r, int angle, int axis){
+    int x, y;
+
+    if(!nradii)
+        return shootingPoints[r][angle][axis];
+    shooting_rebuild(r, angle, &x, &y);
+    return axis ? y : x;
+}
+
+void shooting_print(void){
+    int centers[SHOOTING_MAX], shape[3]={nradii, SHOOTING_OCTANT, 2};
+    char dims[48];
+
+    printf("enum   SHOOTING_RADII  {");
+    for(int r=0;r<nradii;r++)
+        printf("SHOOTING_R%d, ", shooting_radii[r]);
+    printf("MAX_SHOOTING_RADII};\n\n");
+    for(int r=0;r<nradii;r++)
+        centers[r]=shooting_radii[r]-2;
+    emit_table("u8", "ShootingCenter", "[MAX_SHOOTING_RADII]", centers, shape, 1);
+    snprintf(dims, sizeof(dims), "[MAX_SHOOTING_RADII][%d][2]", SHOOTING_OCTANT);
+    emit_table("u8", "ShootingOctant", dims, &shooting_octant[0][0][0], shape, 3);
+
+    printf("// Spawn point of angle around a sprite, for radius SHOOTING_Rn. The angle is taken back to the first quadrant\n");
+    printf("// with the aim_matrix quadrant rules, and to the octant by swapping x and y\n");
+    printf("static void ShootingSpawn(u8 radius, u8 angle, u8 *x, u8 *y){\n");
+    printf("    const u8 (*octant)[2] = ShootingOctant[radius];\n");
+    printf("    u8 c = ShootingCenter[radius], k, ox, oy;\n");
+    printf("    angle &= %d;\n", PATH_ANGLES-1);
+    printf("    k = angle;\n");
+    printf("    if(k > 96)\n");
+    printf("        k = 128 - k;        // dx >= 0, dy < 0\n");
+    printf("    else if(k > 64)\n");
+    printf("        k = k - 64;         // dx < 0, dy < 0\n");
+    printf("    else if(k > 32)\n");
+    printf("        k = 64 - k;         // dx < 0, dy >= 0\n");
+    printf("    if(k > %d){\n", ANGLES_PER_QUADRANT/2);
+    printf("        ox = octant[%d - k][1];\n", ANGLES_PER_QUADRANT);
+    printf("        oy = octant[%d - k][0];\n", ANGLES_PER_QUADRANT);
+    printf("    }else{\n");
+    printf("        ox = octant[k][0];\n");
+    printf("        oy = octant[k][1];\n");
+    printf("    }\n");
+    printf("    *x = (angle > 32 && angle < 96) ? c - ox : c + ox;\n");
+    printf("    *y = angle > 64 ? c - oy : c + oy;\n");
+    printf("}\n\n");
+}
+
+void shooting_print_externs(void){
+    printf("extern %su8 ShootingCenter[MAX_SHOOTING_RADII];\n", emit_const("ShootingCenter"));
+    printf("extern %su8 ShootingOctant[MAX_SHOOTING_RADII][%d][2];\n", emit_const("ShootingOctant"), SHOOTING_OCTANT);
+}
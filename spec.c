@@ -0,0 +1,607 @@
+#include <ctype.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "generator.h"
+
+/*
+
+Paths described in a text file instead of main(). One path per line, a kind, a name and key=value pairs, # starts
+a comment:
+
+    line     Dive       angle=32 speed=2 steps=16
+    arc      Loop       radius=24 start=0 sweep=128 speed=2
+    sine     Wave       angle=32 speed=1 amplitude=12 period=32 steps=64
+    ease     Drop       dx=0 dy=86 curve=out-sine steps=30
+    bezier   Swoop      p1=60,0 p2=60,90 p3=0,90 steps=40 curve=in-out-quad
+    sequence DiveLoop   of=Dive,Loop
+    mirror   DiveLeft   of=Dive axis=x
+
+Angles are PathAngleLUT indices (0 to 127, 32 is straight down, fractions allowed). An arc starts on its circle at
+the start angle, and a positive sweep turns the same way as the angle indices (clockwise on the screen). A sine
+moves along angle and oscillates across it. ease and bezier go from (0, 0) to the end point, with the curve giving
+the time along the path. ease has a few more keys, for paths that must match old hand written ones:
+
+    origin=x,y      where the path starts, the positions are origin + (dx, dy)*curve before rounding
+    t=end|begin     a step goes to the curve at the end of its time slice (default), or at the beginning, so
+                    the first step is 0
+    backwards=yes   walk the curve from the end point back to the origin
+    round=trunc     round the positions towards 0 like a C cast, instead of to nearest
+
+sequence and mirror use paths given before them in the file; mirror flips dx (axis=x), dy (axis=y) or both (axis=xy).
+
+arc and bezier take steps, or a speed to derive the steps from their length. The curves are the ones of ease.c:
+linear, in/out/in-out of quad, cubic, sine and bounce.
+
+Every path is compiled and printed as soon as its line is read: the positions are rounded, and the steps are the
+differences between the rounded positions, so the rounding errors never add up. Each path becomes
+const i8 Name[NAME_STEPS][2], unless it has a store key:
+
+    store=pairs     the default, Name[NAME_STEPS][2]
+    store=axis      a path moving along x or y only, one byte per step
+    store=rle       runs of the same step as count, dx, dy (count, d along a single axis), count 1 to 255
+    store=auto      the smallest of the three
+
+A path that isn't stored as pairs is a flat Name[N] and a SpecStream NameStream, read one step per frame with
+SpecStep(), which is printed once before the first one. Eased paths are mostly runs of the same step at their
+slow end, so rle usually halves them.
+
+*/
+
+#define SPEC_LINE       1024
+#define SPEC_KEYS       16
+#define SPEC_MAX_STEPS  4096
+
+enum SPEC_FORMATS {SPEC_PAIRS, SPEC_X, SPEC_Y, SPEC_RLE_PAIRS, SPEC_RLE_X, SPEC_RLE_Y, SPEC_FORMATS};
+enum SPEC_KINDS {SPEC_LINE_PATH, SPEC_ARC, SPEC_SINE, SPEC_EASE, SPEC_BEZIER, SPEC_SEQUENCE, SPEC_MIRROR, SPEC_KINDS};
+
+static const char *spec_kinds[SPEC_KINDS]={"line", "arc", "sine", "ease", "bezier", "sequence", "mirror"};
+static const char *spec_formats[SPEC_FORMATS]={"SPEC_PAIRS", "SPEC_X", "SPEC_Y", "SPEC_RLE_PAIRS", "SPEC_RLE_X", "SPEC_RLE_Y"};
+
+typedef struct SpecPath{
+    char    name[64];
+    int     steps, format, bytes;
+    int     (*deltas)[2];
+}SpecPath;
+
+typedef struct SpecLine{
+    const char  *file;
+    int         number;
+    char        *keys[SPEC_KEYS], *values[SPEC_KEYS];
+    int         count;
+}SpecLine;
+
+static SpecPath *paths;
+static int npaths, max_paths;
+static bool streams;
+
+static void spec_error(const SpecLine *l, const char *message, const char *what){
+    fprintf(stderr, "%s:%d: %s%s\n", l->file, l->number, message, what);
+}
+
+static const char *spec_get(const SpecLine *l, const char *key){
+    for(int i=0;i<l->count;i++)
+        if(!strcmp(l->keys[i], key))
+            return l->values[i];
+    return NULL;
+}
+
+// Reads a number key. Returns false if it is missing and required, or not a number
+static bool spec_number(const SpecLine *l, const char *key, double *value, bool required){
+    const char *text=spec_get(l, key);
+    char *end;
+
+    if(!text){
+        if(required)
+            spec_error(l, "missing ", key);
+        return !required;
+    }
+    *value=strtod(text, &end);
+    if(end==text || *end){
+        spec_error(l, "not a number: ", key);
+        return false;
+    }
+    return true;
+}
+
+// Reads an x,y key
+static bool spec_point(const SpecLine *l, const char *key, double *p){
+    const char *text=spec_get(l, key);
+    char *end;
+
+    if(!text){
+        spec_error(l, "missing ", key);
+        return false;
+    }
+    p[0]=strtod(text, &end);
+    if(end==text || *end!=','){
+        spec_error(l, "not an x,y point: ", key);
+        return false;
+    }
+    text=end+1;
+    p[1]=strtod(text, &end);
+    if(end==text || *end){
+        spec_error(l, "not an x,y point: ", key);
+        return false;
+    }
+    return true;
+}
+
+// Reads steps, or derives them from the length of the path and a speed
+static bool spec_steps(const SpecLine *l, double length, int *steps){
+    double value=0, speed=0;
+
+    if(!spec_number(l, "steps", &value, false) || !spec_number(l, "speed", &speed, false))
+        return false;
+    if(value==0 && speed>0)
+        value=ceil(length/speed-0.001);
+    if(value<1 || value>SPEC_MAX_STEPS || value!=floor(value)){
+        spec_error(l, "steps must be a whole number from 1 to 4096", "");
+        return false;
+    }
+    *steps=value;
+    return true;
+}
+
+static bool spec_curve(const SpecLine *l, int *curve){
+    const char *text=spec_get(l, "curve");
+
+    *curve=text ? ease_find(text) : EASE_LINEAR;
+    if(*curve<0){
+        spec_error(l, "unknown curve: ", text);
+        return false;
+    }
+    return true;
+}
+
+static SpecPath *spec_find(const char *name){
+    for(int i=0;i<npaths;i++)
+        if(!strcmp(paths[i].name, name))
+            return &paths[i];
+    return NULL;
+}
+
+static SpecPath *spec_new(const char *name, int steps){
+    SpecPath *p;
+
+    if(npaths==max_paths){
+        max_paths=max_paths ? max_paths*2 : 64;
+        paths=realloc(paths, max_paths*sizeof(SpecPath));
+    }
+    p=&paths[npaths++];
+    snprintf(p->name, sizeof(p->name), "%s", name);
+    p->steps=steps;
+    p->deltas=calloc(steps, sizeof(*p->deltas));
+    return p;
+}
+
+// Reads a key that is one of two words, false when missing
+static bool spec_choice(const SpecLine *l, const char *key, const char *no, const char *yes, bool *value){
+    const char *text=spec_get(l, key);
+
+    *value=text && !strcmp(text, yes);
+    if(text && !*value && strcmp(text, no)){
+        fprintf(stderr, "%s:%d: %s must be %s or %s\n", l->file, l->number, key, no, yes);
+        return false;
+    }
+    return true;
+}
+
+static int spec_round(double v, bool trunc){
+    return trunc ? (int)v : lround(v);
+}
+
+// Steps between the rounded positions (x[i], y[i]), i from 1 to steps, starting at start
+static void spec_deltas(SpecPath *p, const double (*pos)[2], const double *start, bool trunc){
+    int px=spec_round(start[0], trunc), py=spec_round(start[1], trunc);
+
+    for(int i=0;i<p->steps;i++){
+        int cx=spec_round(pos[i][0], trunc), cy=spec_round(pos[i][1], trunc);
+        p->deltas[i][0]=cx-px;
+        p->deltas[i][1]=cy-py;
+        px=cx;
+        py=cy;
+    }
+}
+
+static SpecPath *spec_compile(const SpecLine *l, int kind, const char *name){
+    double angle, speed, radius, start, sweep, amplitude, period, end[2], p1[2], p2[2], p3[2], (*pos)[2], origin[2]={0, 0};
+    int steps, curve;
+    bool begin=false, backwards=false, trunc=false;
+    SpecPath *p=NULL;
+
+    switch(kind){
+        case SPEC_LINE_PATH:
+            if(!spec_number(l, "angle", &angle, true) || !spec_number(l, "speed", &speed, true) || !spec_steps(l, 0, &steps))
+                return NULL;
+            p=spec_new(name, steps);
+            linear_row(angle*2*M_PI/PATH_ANGLES, speed, steps, p->deltas);
+            return p;
+        case SPEC_ARC:
+            if(!spec_number(l, "radius", &radius, true) || !spec_number(l, "start", &start, true) ||
+                !spec_number(l, "sweep", &sweep, true))
+                return NULL;
+            start*=2*M_PI/PATH_ANGLES;
+            sweep*=2*M_PI/PATH_ANGLES;
+            if(!spec_steps(l, fabs(sweep)*radius, &steps))
+                return NULL;
+            pos=malloc(steps*sizeof(*pos));
+            for(int i=0;i<steps;i++){
+                double a=start+sweep*(i+1)/steps;
+                pos[i][0]=radius*(cos(a)-cos(start));
+                pos[i][1]=radius*(sin(a)-sin(start));
+            }
+            break;
+        case SPEC_SINE:
+            if(!spec_number(l, "angle", &angle, true) || !spec_number(l, "speed", &speed, true) ||
+                !spec_number(l, "amplitude", &amplitude, true) || !spec_number(l, "period", &period, true) ||
+                !spec_steps(l, 0, &steps))
+                return NULL;
+            if(period<=0){
+                spec_error(l, "period must be positive", "");
+                return NULL;
+            }
+            angle*=2*M_PI/PATH_ANGLES;
+            pos=malloc(steps*sizeof(*pos));
+            for(int i=0;i<steps;i++){
+                double along=speed*(i+1), across=amplitude*sin(2*M_PI*(i+1)/period);
+                pos[i][0]=along*cos(angle)-across*sin(angle);
+                pos[i][1]=along*sin(angle)+across*cos(angle);
+            }
+            break;
+        case SPEC_EASE:
+            if(!spec_number(l, "dx", &end[0], true) || !spec_number(l, "dy", &end[1], true) || !spec_curve(l, &curve) ||
+                !spec_steps(l, hypot(end[0], end[1]), &steps) || (spec_get(l, "origin") && !spec_point(l, "origin", origin)) ||
+                !spec_choice(l, "t", "end", "begin", &begin) || !spec_choice(l, "backwards", "no", "yes", &backwards) ||
+                !spec_choice(l, "round", "nearest", "trunc", &trunc))
+                return NULL;
+            pos=malloc(steps*sizeof(*pos));
+            for(int i=0;i<steps;i++){
+                int k=begin ? i : i+1;
+                double t=ease_value(curve, (double)(backwards ? steps-k : k)/steps);
+                pos[i][0]=origin[0]+end[0]*t;
+                pos[i][1]=origin[1]+end[1]*t;
+            }
+            // where the rounding of the first step starts from
+            start=ease_value(curve, backwards);
+            origin[0]+=end[0]*start;
+            origin[1]+=end[1]*start;
+            break;
+        case SPEC_BEZIER:
+            if(!spec_point(l, "p1", p1) || !spec_point(l, "p2", p2) || !spec_point(l, "p3", p3) || !spec_curve(l, &curve))
+                return NULL;
+            // the control polygon is longer than the curve, close enough to derive the steps from a speed
+            if(!spec_steps(l, hypot(p1[0], p1[1])+hypot(p2[0]-p1[0], p2[1]-p1[1])+hypot(p3[0]-p2[0], p3[1]-p2[1]), &steps))
+                return NULL;
+            pos=malloc(steps*sizeof(*pos));
+            for(int i=0;i<steps;i++){
+                double t=ease_value(curve, (double)(i+1)/steps), u=1-t;
+                for(int axis=0;axis<2;axis++)
+                    pos[i][axis]=3*u*u*t*p1[axis]+3*u*t*t*p2[axis]+t*t*t*p3[axis];
+            }
+            break;
+        case SPEC_SEQUENCE:
+        case SPEC_MIRROR:{
+            const char *of=spec_get(l, "of"), *axis=kind==SPEC_MIRROR ? spec_get(l, "axis") : "";
+            char list[SPEC_LINE], *part;
+            int total=0, flip[2];
+
+            if(!of){
+                spec_error(l, "missing ", "of");
+                return NULL;
+            }
+            if(!axis || (strcmp(axis, "x") && strcmp(axis, "y") && strcmp(axis, "xy") && kind==SPEC_MIRROR)){
+                spec_error(l, "axis must be x, y or xy", "");
+                return NULL;
+            }
+            flip[0]=strchr(axis, 'x') ? -1 : 1;
+            flip[1]=strchr(axis, 'y') ? -1 : 1;
+            snprintf(list, sizeof(list), "%s", of);
+            for(part=strtok(list, ",");part;part=strtok(NULL, ",")){
+                SpecPath *src=spec_find(part);
+                if(!src){
+                    spec_error(l, "unknown path: ", part);
+                    return NULL;
+                }
+                if(kind==SPEC_MIRROR && total){
+                    spec_error(l, "mirror takes a single path", "");
+                    return NULL;
+                }
+                total+=src->steps;
+            }
+            if(total>SPEC_MAX_STEPS){
+                spec_error(l, "too many steps", "");
+                return NULL;
+            }
+            p=spec_new(name, total);
+            total=0;
+            snprintf(list, sizeof(list), "%s", of);
+            for(part=strtok(list, ",");part;part=strtok(NULL, ",")){
+                SpecPath *src=spec_find(part);
+                for(int i=0;i<src->steps;i++,total++){
+                    p->deltas[total][0]=src->deltas[i][0]*flip[0];
+                    p->deltas[total][1]=src->deltas[i][1]*flip[1];
+                }
+            }
+            return p;
+        }
+    }
+    p=spec_new(name, steps);
+    spec_deltas(p, (const double (*)[2])pos, origin, trunc);
+    free(pos);
+    return p;
+}
+
+static bool spec_identifier(const char *name){
+    if(!isalpha((unsigned char)*name) && *name!='_')
+        return false;
+    for(;*name;name++)
+        if(!isalnum((unsigned char)*name) && *name!='_')
+            return false;
+    return true;
+}
+
+// Name of the steps #define: Dive -> DIVE_STEPS
+static void spec_define(const char *name, char *define){
+    while(*name)
+        *define++=toupper((unsigned char)*name++);
+    strcpy(define, "_STEPS");
+}
+
+// Values of a step in format: both deltas, or the one of the axis
+static int spec_values(int format, const int *delta, int *out){
+    int axis=format%3-1;
+
+    if(axis<0){
+        out[0]=delta[0];
+        out[1]=delta[1];
+        return 2;
+    }
+    out[0]=delta[axis];
+    return 1;
+}
+
+// Stores the steps of p in format, returns the bytes. out can be NULL to only count them
+static int spec_encode(const SpecPath *p, int format, int *out){
+    int bytes=0, v[2];
+
+    for(int i=0;i<p->steps;){
+        int run=1, n;
+        if(format>=SPEC_RLE_PAIRS){
+            while(i+run<p->steps && run<255 && p->deltas[i+run][0]==p->deltas[i][0] && p->deltas[i+run][1]==p->deltas[i][1])
+                run++;
+            if(out)
+                out[bytes]=run>127 ? run-256 : run;   // read back as u8
+            bytes++;
+        }
+        n=spec_values(format, p->deltas[i], v);
+        for(int k=0;k<n;k++,bytes++)
+            if(out)
+                out[bytes]=v[k];
+        i+=run;
+    }
+    return bytes;
+}
+
+// Walks the stored bytes the way SpecStep() does and checks it gives the steps back
+static bool spec_check(const SpecPath *p, const int *data){
+    int next=0, run=0;
+
+    for(int i=0;i<p->steps;i++){
+        int d[2]={0, 0}, at=next, n=p->format%3 ? 1 : 2;
+        if(p->format>=SPEC_RLE_PAIRS){
+            if(!run)
+                run=data[next]&255;
+            at++;
+            if(--run==0)
+                next+=1+n;
+        }
+        else
+            next+=n;
+        if(n==2){
+            d[0]=data[at];
+            d[1]=data[at+1];
+        }
+        else
+            d[p->format%3-1]=data[at];
+        if(d[0]!=p->deltas[i][0] || d[1]!=p->deltas[i][1])
+            return false;
+    }
+    return true;
+}
+
+// Reads the store key and picks the format of p. Returns false on a wrong store
+static bool spec_store(const SpecLine *l, SpecPath *p){
+    const char *store=spec_get(l, "store");
+    int axis=-1, candidates[3];
+
+    // the axis that moves, -1 if both do
+    for(int a=0;a<2 && axis<0;a++){
+        axis=a;
+        for(int i=0;i<p->steps;i++)
+            if(p->deltas[i][1-a])
+                axis=-1;
+    }
+    candidates[0]=SPEC_PAIRS;
+    candidates[1]=axis<0 ? SPEC_PAIRS : SPEC_X+axis;
+    candidates[2]=axis<0 ? SPEC_RLE_PAIRS : SPEC_RLE_X+axis;
+    if(!store || !strcmp(store, "pairs"))
+        p->format=SPEC_PAIRS;
+    else if(!strcmp(store, "axis")){
+        if(axis<0){
+            spec_error(l, "store=axis on a path moving along x and y: ", p->name);
+            return false;
+        }
+        p->format=candidates[1];
+    }
+    else if(!strcmp(store, "rle"))
+        p->format=candidates[2];
+    else if(!strcmp(store, "auto")){
+        p->format=SPEC_PAIRS;
+        for(int c=1;c<3;c++)
+            if(spec_encode(p, candidates[c], NULL)<spec_encode(p, p->format, NULL))
+                p->format=candidates[c];
+    }
+    else{
+        spec_error(l, "store must be pairs, axis, rle or auto: ", store);
+        return false;
+    }
+    p->bytes=spec_encode(p, p->format, NULL);
+    return true;
+}
+
+// SpecStream and SpecStep(), before the first path that needs them
+static void spec_print_stream(void){
+    printf("// A path stored as bytes, walked with SpecStart() and SpecStep(). RLE formats are runs of count (1 to 255), then the step\n");
+    printf("enum   SPEC_FORMATS {");
+    for(int i=0;i<SPEC_FORMATS;i++)
+        printf("%s, ", spec_formats[i]);
+    printf("SPEC_NFORMATS};\n\n");
+    printf("typedef struct SpecStream{\n");
+    printf("    const i8  *data;\n");
+    printf("    u16 steps;\n");
+    printf("    u8  format;\n");
+    printf("}SpecStream;\n\n");
+    printf("typedef struct SpecWalker{\n");
+    printf("    const i8  *next;\n");
+    printf("    u16 left;\n");
+    printf("    u8  run;\n");
+    printf("    u8  format;\n");
+    printf("}SpecWalker;\n\n");
+    printf("static void SpecStart(SpecWalker *w, const SpecStream *s){\n");
+    printf("    w->next = s->data;\n");
+    printf("    w->left = s->steps;\n");
+    printf("    w->run = 0;\n");
+    printf("    w->format = s->format;\n");
+    printf("}\n\n");
+    printf("// Next step of the path in (dx, dy), returns 0 once the path is over\n");
+    printf("static u8 SpecStep(SpecWalker *w, i8 *dx, i8 *dy){\n");
+    printf("    const i8 *v = w->next;\n");
+    printf("    u8 axis = w->format %% 3;   // 0 pairs, 1 x, 2 y\n");
+    printf("    if(!w->left)\n");
+    printf("        return 0;\n");
+    printf("    w->left--;\n");
+    printf("    if(w->format >= SPEC_RLE_PAIRS){\n");
+    printf("        if(!w->run)\n");
+    printf("            w->run = (u8)*v;\n");
+    printf("        v++;\n");
+    printf("        if(--w->run == 0)\n");
+    printf("            w->next += axis ? 2 : 3;\n");
+    printf("    }\n");
+    printf("    else\n");
+    printf("        w->next += axis ? 1 : 2;\n");
+    printf("    *dx = axis == 2 ? 0 : v[0];\n");
+    printf("    *dy = axis == 0 ? v[1] : axis == 2 ? v[0] : 0;\n");
+    printf("    return 1;\n");
+    printf("}\n\n");
+}
+
+static bool spec_print(const SpecPath *p, const char *kind){
+    char define[80], dims[96], stream[80];
+    int shape[2]={p->steps, 2}, *data;
+
+    spec_define(p->name, define);
+    if(p->format==SPEC_PAIRS){
+        printf("// %s %s\n", kind, p->name);
+        snprintf(dims, sizeof(dims), "[%s][2]", define);
+        printf("#define %s %d\n", define, p->steps);
+        emit_table("i8", p->name, dims, &p->deltas[0][0], shape, 2);
+        return true;
+    }
+    data=malloc(p->bytes*sizeof(int));
+    spec_encode(p, p->format, data);
+    if(!spec_check(p, data)){
+        fprintf(stderr, "spec: %s doesn't walk back to its steps as %s\n", p->name, spec_formats[p->format]);
+        free(data);
+        return false;
+    }
+    if(!streams)
+        spec_print_stream();
+    streams=true;
+    printf("// %s %s\n", kind, p->name);
+    printf("// %s, %d bytes instead of %d, walk it with SpecStep()\n", spec_formats[p->format], p->bytes, p->steps*2);
+    printf("#define %s %d\n", define, p->steps);
+    snprintf(dims, sizeof(dims), "[%d]", p->bytes);
+    shape[0]=p->bytes;
+    emit_table("i8", p->name, dims, data, shape, 1);
+    snprintf(stream, sizeof(stream), "%sStream", p->name);
+    printf("const SpecStream %s={ %s, %s, %s};\n\n", stream, p->name, define, spec_formats[p->format]);
+    fprintf(stderr, "spec: %s stored as %s, %d bytes instead of %d\n", p->name, spec_formats[p->format], p->bytes, p->steps*2);
+    free(data);
+    return true;
+}
+
+// Reads the spec file (- for stdin) and prints every path as soon as it is compiled. Returns false on the first error
+bool spec_print_paths(const char *file){
+    FILE *f=strcmp(file, "-") ? fopen(file, "r") : stdin;
+    char text[SPEC_LINE];
+    SpecLine l={.file=file};
+
+    if(!f){
+        fprintf(stderr, "%s: can't open\n", file);
+        return false;
+    }
+    while(fgets(text, sizeof(text), f)){
+        char *kind, *name, *token, *hash=strchr(text, '#');
+        int k;
+        SpecPath *p;
+
+        l.number++;
+        l.count=0;
+        if(hash)
+            *hash=0;
+        kind=strtok(text, " \t\r\n");
+        if(!kind)
+            continue;
+        name=strtok(NULL, " \t\r\n");
+        for(k=0;k<SPEC_KINDS && strcmp(spec_kinds[k], kind);k++);
+        if(k==SPEC_KINDS){
+            spec_error(&l, "unknown path kind: ", kind);
+            return false;
+        }
+        if(!name || !spec_identifier(name) || strlen(name)>=sizeof(p->name)){
+            spec_error(&l, "a path needs a C identifier as name", "");
+            return false;
+        }
+        if(spec_find(name)){
+            spec_error(&l, "path given twice: ", name);
+            return false;
+        }
+        while((token=strtok(NULL, " \t\r\n"))){
+            char *equal=strchr(token, '=');
+            if(!equal || l.count==SPEC_KEYS){
+                spec_error(&l, "expected key=value: ", token);
+                return false;
+            }
+            *equal=0;
+            l.keys[l.count]=token;
+            l.values[l.count++]=equal+1;
+        }
+        if(!(p=spec_compile(&l, k, name)))
+            return false;
+        for(int i=0;i<p->steps;i++)
+            if(abs(p->deltas[i][0])>127 || abs(p->deltas[i][1])>127){
+                spec_error(&l, "a step doesn't fit in i8: ", name);
+                return false;
+            }
+        if(!spec_store(&l, p) || !spec_print(p, kind))
+            return false;
+    }
+    if(f!=stdin)
+        fclose(f);
+    fprintf(stderr, "spec: %d paths from %s\n", npaths, file);
+    return true;
+}
+
+void spec_print_externs(void){
+    for(int i=0;i<npaths;i++){
+        char define[80];
+        spec_define(paths[i].name, define);
+        if(paths[i].format==SPEC_PAIRS){
+            printf("extern %si8 %s[%s][2];\n", emit_const(paths[i].name), paths[i].name, define);
+            continue;
+        }
+        printf("extern %si8 %s[%d];\n", emit_const(paths[i].name), paths[i].name, paths[i].bytes);
+        printf("extern const SpecStream %sStream;\n", paths[i].name);
+    }
+}
@@ -0,0 +1,220 @@
+#include <ctype.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "generator.h"
+#include "z80.h"
+
+/*
+
+Steering for homing enemies. The turn toward the target only depends on the difference of the two angles, so the
+table is indexed by (target - angle) & 127 instead of by both, 128 bytes per turn rate instead of 16 KB, and the
+wraparound is in the index:
+
+    angle = (angle + SteerTable[steer][(target - angle) & 127]) & 127;
+
+A row is a max turn rate R (angles per frame) and a profile. "constant" turns R until the target is less than R
+away; an ease curve turns R * curve(|difference| / 64), so the turn slows down close to the target. A turn is at
+least 1 and never passes the target. The difference 64 (target right behind) turns clockwise.
+
+The rows are simulated from every difference to report the frames to converge, and the table read is run on the
+Z80 model against the branchy code it replaces, clamping the signed difference to R.
+
+*/
+
+#define STEER_MAX       16
+#define STEER_DEFAULT   "2:constant,4:constant,4:out-quad,8:in-out-sine"
+#define STEER_ROW       0x4000
+#define STEER_STACK     0xF380
+#define STEER_MISSILES  12
+
+typedef struct Steer{
+    int     rate, profile;      // profile -1 is constant
+    char    name[48];           // rate, _ and a profile of up to 31 characters
+    int     turn[PATH_ANGLES];
+}Steer;
+
+static Steer steers[STEER_MAX];
+static int nsteers;
+static Z80 steer_cpu;
+
+static int steer_signed(int difference){
+    difference&=PATH_ANGLES-1;
+    return difference<=PATH_ANGLES/2 ? difference : difference-PATH_ANGLES;
+}
+
+static void steer_build_row(Steer *s){
+    for(int i=0;i<PATH_ANGLES;i++){
+        int d=steer_signed(i), size=abs(d), turn;
+        if(s->profile<0)
+            turn=size<s->rate ? size : s->rate;
+        else{
+            turn=lround(s->rate*ease_value(s->profile, size/(double)(PATH_ANGLES/2)));
+            turn=turn<1 ? 1 : turn;
+            turn=turn>size ? size : turn;
+        }
+        s->turn[i]=d<0 ? -turn : turn;
+    }
+}
+
+// In: A = target, C = angle. Out: C = the new angle. The row at SteerRow
+static Z80Program *steer_table_routine(void){
+    Z80Program *p=z80_new("SteerTable");
+
+    z_alu(p, ALU_SUB, R_C);
+    z_alun(p, ALU_AND, PATH_ANGLES-1);
+    z_ld(p, R_E, R_A);
+    z_ldn(p, R_D, 0);
+    z_ld16(p, RP_HL, 0, "SteerRow");
+    z_add16(p, RP_DE);
+    z_ld(p, R_A, R_HLI);
+    z_alu(p, ALU_ADD, R_C);
+    z_alun(p, ALU_AND, PATH_ANGLES-1);
+    z_ld(p, R_C, R_A);
+    z_ret(p, CC_ALWAYS);
+    return p;
+}
+
+// Same, with the signed difference clamped to rate the way the game does it now
+static Z80Program *steer_branch_routine(int rate){
+    Z80Program *p=z80_new("SteerBranch");
+
+    z_alu(p, ALU_SUB, R_C);
+    z_alun(p, ALU_AND, PATH_ANGLES-1);
+    z_ret(p, CC_Z);                     // on target
+    z_alun(p, ALU_CP, PATH_ANGLES/2+1);
+    z_jr(p, CC_NC, ".left");
+    z_alun(p, ALU_CP, rate+1);          // 1 to 64: clockwise
+    z_jr(p, CC_C, ".turn");
+    z_ldn(p, R_A, rate);
+    z_jr(p, CC_ALWAYS, ".turn");
+    z_label(p, ".left");                // 65 to 127: -63 to -1
+    z_alun(p, ALU_CP, PATH_ANGLES-rate);
+    z_jr(p, CC_NC, ".turn");
+    z_ldn(p, R_A, PATH_ANGLES-rate);
+    z_label(p, ".turn");
+    z_alu(p, ALU_ADD, R_C);
+    z_alun(p, ALU_AND, PATH_ANGLES-1);
+    z_ld(p, R_C, R_A);
+    z_ret(p, CC_ALWAYS);
+    return p;
+}
+
+// Runs the routine for every angle and target, checks the new angle, returns the average T-states with M1 or -1
+static double steer_run(Z80Program *p, const Steer *s, long *max){
+    long total=0;
+
+    if(!z80_link(&steer_cpu, p))
+        return -1;
+    *max=0;
+    for(int angle=0;angle<PATH_ANGLES;angle++)
+        for(int target=0;target<PATH_ANGLES;target++){
+            long m1=steer_cpu.m1, t;
+            steer_cpu.r[R_A]=target;
+            steer_cpu.r[R_C]=angle;
+            steer_cpu.sp=STEER_STACK;
+            t=z80_call(&steer_cpu, p);
+            t+=steer_cpu.m1-m1;
+            if(steer_cpu.r[R_C]!=((angle+s->turn[(target-angle)&(PATH_ANGLES-1)])&(PATH_ANGLES-1))){
+                fprintf(stderr, "steer: %s turns %d toward %d to %d\n", p->name, angle, target, steer_cpu.r[R_C]);
+                return -1;
+            }
+            total+=t;
+            *max=t>*max ? t : *max;
+        }
+    return total/(double)(PATH_ANGLES*PATH_ANGLES);
+}
+
+// Reads --steer, an empty list for the default rows, builds and simulates them. False with a message on stderr
+bool steer_build(const char *list){
+    if(!*list)
+        list=STEER_DEFAULT;
+    nsteers=0;
+    while(*list){
+        Steer *s=&steers[nsteers];
+        size_t length=strcspn(list, ",");
+        char profile[32], *end;
+        if(nsteers==STEER_MAX){
+            fprintf(stderr, "steer: more than %d rows\n", STEER_MAX);
+            return false;
+        }
+        s->rate=strtol(list, &end, 10);
+        if(*end!=':' || end>=list+length || list+length-end>(long)sizeof(profile) || s->rate<1 || s->rate>=PATH_ANGLES/2){
+            fprintf(stderr, "steer: %.*s is wrong, it must be RATE:PROFILE with a rate of 1 to %d\n", (int)length, list, PATH_ANGLES/2-1);
+            return false;
+        }
+        snprintf(profile, sizeof(profile), "%.*s", (int)(list+length-end-1), end+1);
+        s->profile=strcmp(profile, "constant") ? ease_find(profile) : -1;
+        if(s->profile<0 && strcmp(profile, "constant")){
+            fprintf(stderr, "steer: unknown profile %s, it must be constant or an ease curve like out-quad\n", profile);
+            return false;
+        }
+        snprintf(s->name, sizeof(s->name), "%d_%s", s->rate, profile);
+        for(char *c=s->name;*c;c++)
+            *c=*c=='-' ? '_' : toupper(*c);
+        for(int i=0;i<nsteers;i++)
+            if(!strcmp(steers[i].name, s->name)){
+                fprintf(stderr, "steer: %.*s is there twice\n", (int)length, list);
+                return false;
+            }
+        steer_build_row(s);
+        nsteers++;
+        list+=length+(list[length]==',');
+    }
+    for(int i=0;i<nsteers;i++){
+        Steer *s=&steers[i];
+        int max=0, total=0;
+        uint8_t row[PATH_ANGLES];
+        Z80Program *table=steer_table_routine(), *branch=steer_branch_routine(s->rate);
+        long table_max, branch_max;
+        double table_avg, branch_avg=0;
+        // frames from every difference to the target
+        for(int d=0;d<PATH_ANGLES;d++){
+            int frames=0;
+            for(int left=d;left;frames++)
+                left=(left-s->turn[left])&(PATH_ANGLES-1);
+            max=frames>max ? frames : max;
+            total+=frames;
+        }
+        for(int d=0;d<PATH_ANGLES;d++)
+            row[d]=s->turn[d];
+        z80_load(&steer_cpu, "SteerRow", STEER_ROW, row, PATH_ANGLES);
+        table_avg=steer_run(table, s, &table_max);
+        if(s->profile<0)
+            branch_avg=steer_run(branch, s, &branch_max);
+        z80_free(table);
+        z80_free(branch);
+        if(table_avg<0 || branch_avg<0)
+            return false;
+        fprintf(stderr, "steer: STEER_%-16s %4.1f frames to converge on average, %2d at most, table read %.1f T-states (MSX) max %ld",
+            s->name, total/(double)PATH_ANGLES, max, table_avg, table_max);
+        if(s->profile<0)
+            fprintf(stderr, ", branches %.1f max %ld, %.0f T-states saved for %d missiles", branch_avg, branch_max,
+                (branch_avg-table_avg)*STEER_MISSILES, STEER_MISSILES);
+        fprintf(stderr, "\n");
+    }
+    return true;
+}
+
+void steer_print(void){
+    int *values=malloc(nsteers*PATH_ANGLES*sizeof(int)), shape[2]={nsteers, PATH_ANGLES};
+
+    printf("enum   STEERS {");
+    for(int i=0;i<nsteers;i++)
+        printf("STEER_%s, ", steers[i].name);
+    printf("STEER_ROWS};\n\n");
+    for(int i=0;i<nsteers;i++)
+        for(int d=0;d<PATH_ANGLES;d++)
+            values[i*PATH_ANGLES+d]=steers[i].turn[d];
+    printf("// Signed turn toward the target: SteerTable[steer][(target - angle) & %d]\n", PATH_ANGLES-1);
+    emit_table("i8", "SteerTable", "[STEER_ROWS][PATH_ANGLES]", values, shape, 2);
+    printf("// New angle of a homing enemy at angle, turning toward target (from AimAngle() or aim_matrix)\n");
+    printf("static u8 SteerAngle(u8 steer, u8 angle, u8 target){\n");
+    printf("    return (angle + SteerTable[steer][(u8)(target - angle) & %d]) & %d;\n", PATH_ANGLES-1, PATH_ANGLES-1);
+    printf("}\n\n");
+    free(values);
+}
+
+void steer_print_externs(void){
+    printf("extern %si8 SteerTable[STEER_ROWS][PATH_ANGLES];\n", emit_const("SteerTable"));
+}
@@ -0,0 +1,300 @@
+#include <stdlib.h>
+#include <string.h>
+#include "generator.h"
+#include "z80.h"
+
+/*
+
+Batch bullet steppers for the page aligned layouts. SDCC compiles the C loop over PathAngleLUT[angle][step][0/1]
+into IX indexed code with 16 bit address arithmetic. These routines are generated for the layout, PATH_STEPS,
+PATH_ANGLES and the page of the tables instead, and move a contiguous array of bullets in one call:
+
+    void PathStepBatch(u8 count, Bullet *bullets);     // sdcccall(1): A = count, DE = bullets
+
+A bullet is 4 bytes, x, y, angle (0-127), step (0 to PATH_STEPS-1). Every bullet gets x += dx, y += dy of its
+angle and step, and the step advances. The body reads the table with D = page and E = index, without IX, IY or
+16 bit additions, and walks the bullets down from the step of the last one, so HL only moves once per byte. It is
+unrolled U times (--steppers=U): count & (U-1) bullets go through a single bullet loop first, the rest through
+the unrolled one.
+
+The routine of every layout is run on the Z80 model, on batches of 0 to 255 bullets over several frames, and
+compared with the C reference before its cost is reported. The one of --layout is written to DIR/path_step.asm as
+sdasz80 source exporting _PathStepBatch, for sdcc to link.
+--replay measures the one of every layout on batches of every size for its frame costs.
+
+*/
+
+#define STEPPER_BULLETS 0x0100      // bullets of the model, the tables are above STEPPER_LOW
+#define STEPPER_STACK   0x0800
+#define STEPPER_LOW     0x1000
+#define STEPPER_FRAMES  (PATH_STEPS+3)
+
+static Z80 stepper_cpu;
+static int stepper_unroll;
+static BenchCall stepper_costs[LAYOUT_SOA_PAGE+1][256];     // by layout and count, for replay.c
+static const char *stepper_layouts[]={"none", "aos", "soa", "soa-page"};
+
+// Adds (DE) to (HL) and moves HL down to the previous byte of the bullets
+static void stepper_add(Z80Program *p){
+    z_lda_rp(p, RP_DE);
+    z_alu(p, ALU_ADD, R_HLI);
+    z_ld(p, R_HLI, R_A);
+    z_dec16(p, RP_HL);
+}
+
+// One bullet, HL on its step, leaves HL on the step of the bullet before. B is the loop counter and is kept
+static void stepper_body(Z80Program *p, int layout, int page){
+    z_ld(p, R_A, R_HLI);            // C = step, and store the next one
+    z_ld(p, R_C, R_A);
+    z_inc(p, R_A);
+    z_alun(p, ALU_AND, PATH_STEPS-1);
+    z_ld(p, R_HLI, R_A);
+    z_dec16(p, RP_HL);
+    switch(layout){
+        case LAYOUT_AOS:            // D = page + angle/8, E = (angle&7)*32 + step*2, dy at E + 1
+            z_ld(p, R_A, R_HLI);
+            for(int i=0;i<3;i++)
+                z_simple(p, OP_RRCA);
+            z_ld(p, R_E, R_A);
+            z_alun(p, ALU_AND, 0x1F);
+            z_alun(p, ALU_ADD, page);
+            z_ld(p, R_D, R_A);
+            z_shift(p, SH_SLA, R_C);
+            z_ld(p, R_A, R_E);
+            z_alun(p, ALU_AND, 0xE0);
+            z_alu(p, ALU_OR, R_C);
+            z_ld(p, R_E, R_A);
+            z_dec16(p, RP_HL);
+            z_inc(p, R_E);
+            stepper_add(p);
+            z_dec(p, R_E);
+            break;
+        case LAYOUT_SOA:            // D = page + step/2, E = (step&1)*128 + angle, dy 8 pages up
+            z_ld(p, R_A, R_C);
+            z_simple(p, OP_RRCA);
+            z_ld(p, R_C, R_A);
+            z_alun(p, ALU_AND, 0x80);
+            z_alu(p, ALU_OR, R_HLI);
+            z_ld(p, R_E, R_A);
+            z_dec16(p, RP_HL);
+            z_ld(p, R_A, R_C);
+            z_alun(p, ALU_AND, 0x7F);
+            z_alun(p, ALU_ADD, page+(PATH_STEPS*PATH_ANGLES>>8));
+            z_ld(p, R_D, R_A);
+            stepper_add(p);
+            z_ld(p, R_A, R_D);
+            z_alun(p, ALU_SUB, PATH_STEPS*PATH_ANGLES>>8);
+            z_ld(p, R_D, R_A);
+            break;
+        default:                    // D = page + step, E = angle, dy PATH_STEPS pages up
+            z_ld(p, R_E, R_HLI);
+            z_dec16(p, RP_HL);
+            z_ld(p, R_A, R_C);
+            z_alun(p, ALU_ADD, page+PATH_STEPS);
+            z_ld(p, R_D, R_A);
+            stepper_add(p);
+            z_ld(p, R_A, R_C);
+            z_alun(p, ALU_ADD, page);
+            z_ld(p, R_D, R_A);
+            break;
+    }
+    stepper_add(p);
+}
+
+// In: A = count, DE = bullets. The bullets are walked from the last one down
+static Z80Program *stepper_routine(int layout, int page, int unroll){
+    Z80Program *p=z80_new("_PathStepBatch");
+    int shifts=0;
+
+    while((1<<shifts)<unroll)
+        shifts++;
+    z_ld(p, R_B, R_A);
+    z_ld(p, R_L, R_A);              // HL = step of the last bullet
+    z_ldn(p, R_H, 0);
+    z_add16(p, RP_HL);
+    z_add16(p, RP_HL);
+    z_add16(p, RP_DE);
+    z_dec16(p, RP_HL);
+    if(unroll>1){
+        z_alun(p, ALU_AND, unroll-1);
+        z_jr(p, CC_Z, ".blocks");
+        z_push(p, RP_BC);
+        z_ld(p, R_B, R_A);
+        z_label(p, ".single");
+        stepper_body(p, layout, page);
+        z_djnz(p, ".single");
+        z_pop(p, RP_BC);
+        z_label(p, ".blocks");
+        for(int i=0;i<shifts;i++)
+            z_shift(p, SH_SRL, R_B);
+        z_ret(p, CC_Z);
+    }
+    else{
+        z_alu(p, ALU_OR, R_A);
+        z_ret(p, CC_Z);
+    }
+    z_label(p, ".block");
+    for(int i=0;i<unroll;i++)
+        stepper_body(p, layout, page);
+    z_dec(p, R_B);
+    z_jp(p, CC_NZ, ".block");
+    z_ret(p, CC_ALWAYS);
+    return p;
+}
+
+// Loads the path tables of the layout placed from base
+static void stepper_load(int layout, int base){
+    memset(stepper_cpu.mem, 0, sizeof(stepper_cpu.mem));
+    for(int a=0;a<PATH_ANGLES;a++)
+        for(int s=0;s<PATH_STEPS;s++)
+            for(int axis=0;axis<2;axis++){
+                int addr;
+                if(layout==LAYOUT_AOS)
+                    addr=layout_address(layout, base, "PathAngleLUT")+a*PATH_STEPS*2+s*2+axis;
+                else if(layout==LAYOUT_SOA)
+                    addr=layout_address(layout, base, axis ? "PathAngleDY" : "PathAngleDX")+s*PATH_ANGLES+a;
+                else
+                    addr=layout_address(layout, base, axis ? "PathAngleDY" : "PathAngleDX")+s*256+a;
+                stepper_cpu.mem[addr]=path_angle_lut[a][s][axis];
+            }
+}
+
+// Runs the routine on batches of every size and checks the bullets. Returns the MSX T-states per bullet, or -1
+static double stepper_run(Z80Program *p){
+    uint8_t bullets[255][4];
+    long total=0, moved=0;
+
+    srand(1);
+    for(int count=0;count<256;count+=count<16 ? 1 : 17)
+        for(int frame=0;frame<STEPPER_FRAMES;frame++){
+            long m1=stepper_cpu.m1, t;
+            if(!frame)
+                for(int i=0;i<count;i++){
+                    bullets[i][0]=rand();
+                    bullets[i][1]=rand();
+                    bullets[i][2]=rand()%PATH_ANGLES;
+                    bullets[i][3]=rand()%PATH_STEPS;
+                }
+            memcpy(stepper_cpu.mem+STEPPER_BULLETS, bullets, count*4);
+            stepper_cpu.r[R_A]=count;
+            z80_set_pair(&stepper_cpu, RP_DE, STEPPER_BULLETS);
+            stepper_cpu.sp=STEPPER_STACK;
+            t=z80_call(&stepper_cpu, p);
+            t+=stepper_cpu.m1-m1;
+            for(int i=0;i<count;i++){
+                int a=bullets[i][2], s=bullets[i][3];
+                bullets[i][0]+=path_angle_lut[a][s][0];
+                bullets[i][1]+=path_angle_lut[a][s][1];
+                bullets[i][3]=(s+1)&(PATH_STEPS-1);
+            }
+            if(memcmp(stepper_cpu.mem+STEPPER_BULLETS, bullets, count*4)){
+                fprintf(stderr, "stepper: %s moves a batch of %d bullets wrong on frame %d\n", p->name, count, frame);
+                return -1;
+            }
+            if(count>=16){
+                total+=t;
+                moved+=count;
+            }
+        }
+    return total/(double)moved;
+}
+
+static bool stepper_base(int base){
+    if(base<STEPPER_LOW)
+        fprintf(stderr, "stepper: --page-base must be 0x%04X or more, the model keeps its bullets below\n", STEPPER_LOW);
+    return base>=STEPPER_LOW;
+}
+
+// The routine of the layout with its tables loaded from base, checked. NULL if it is wrong, cost is the MSX T-states
+// per bullet
+static Z80Program *stepper_checked(int layout, int base, int unroll, double *cost){
+    int page=layout_address(layout, base, layout==LAYOUT_AOS ? "PathAngleLUT" : "PathAngleDX")>>8;
+    Z80Program *p=stepper_routine(layout, page, unroll);
+
+    stepper_load(layout, base);
+    *cost=z80_link(&stepper_cpu, p) ? stepper_run(p) : -1;
+    if(*cost<0){
+        z80_free(p);
+        return NULL;
+    }
+    return p;
+}
+
+// Builds, checks and measures the routine of every layout, reported on stderr. False if one is wrong
+bool stepper_build(int base, int unroll){
+    stepper_unroll=unroll;
+    if(!stepper_base(base))
+        return false;
+    for(int layout=LAYOUT_AOS;layout<=LAYOUT_SOA_PAGE;layout++){
+        double cost;
+        Z80Program *p=stepper_checked(layout, base, unroll, &cost);
+        if(!p)
+            return false;
+        fprintf(stderr, "stepper: %-8s %dx unrolled, %4d bytes, %.1f T-states (MSX) per bullet, %d bullets per frame at 60 Hz%s\n",
+            stepper_layouts[layout], unroll, z80_size(p), cost, (int)(Z80_FRAME_60HZ/cost), layout==options.layout ? "  <- printed" : "");
+        z80_free(p);
+    }
+    return true;
+}
+
+// Builds and checks the routine of every layout, then runs a batch of every size once for stepper_call(). The body
+// has no branch on the bullets, so the size is all the cost depends on. False if a routine is wrong
+bool stepper_open(int base, int unroll){
+    if(!stepper_base(base))
+        return false;
+    stepper_cpu.watch_start=STEPPER_LOW;
+    stepper_cpu.watch_end=0xFFFF;
+    for(int layout=LAYOUT_AOS;layout<=LAYOUT_SOA_PAGE;layout++){
+        double cost;
+        Z80Program *p=stepper_checked(layout, base, unroll, &cost);
+        if(!p)
+            return false;
+        for(int count=0;count<256;count++){
+            long m1=stepper_cpu.m1, watched=stepper_cpu.watched, t;
+            stepper_cpu.r[R_A]=count;
+            z80_set_pair(&stepper_cpu, RP_DE, STEPPER_BULLETS);
+            stepper_cpu.sp=STEPPER_STACK;
+            t=z80_call(&stepper_cpu, p);
+            stepper_costs[layout][count]=(BenchCall){t+stepper_cpu.m1-m1, stepper_cpu.watched-watched};
+        }
+        z80_free(p);
+    }
+    return true;
+}
+
+const char *stepper_name(int layout){
+    return stepper_layouts[layout];
+}
+
+// MSX T-states and table reads of one PathStepBatch call on count bullets (0-255), as measured by stepper_open()
+BenchCall stepper_call(int layout, int count){
+    return stepper_costs[layout][count];
+}
+
+void stepper_print(void){
+    printf("// Moves count bullets {x, y, angle, step} of --layout=%s tables, path_step.asm in the --out directory\n",
+        stepper_layouts[options.layout]);
+    printf("void PathStepBatch(u8 count, void *bullets);\n\n");
+}
+
+// Writes path_step.asm for the game to link
+bool stepper_finish(const char *dir, int base){
+    char path[1024];
+    int page=layout_address(options.layout, base, options.layout==LAYOUT_AOS ? "PathAngleLUT" : "PathAngleDX")>>8;
+    Z80Program *p=stepper_routine(options.layout, page, stepper_unroll);
+    FILE *f;
+
+    snprintf(path, sizeof(path), "%s/path_step.asm", dir);
+    if(!(f=fopen(path, "w"))){
+        fprintf(stderr, "stepper: can't write %s\n", path);
+        z80_free(p);
+        return false;
+    }
+    fprintf(f, "; Batch bullet stepper for --layout=%s tables from page 0x%02X, %dx unrolled, %d bytes\n",
+        stepper_layouts[options.layout], page, stepper_unroll, z80_size(p));
+    fprintf(f, "; void PathStepBatch(u8 count, void *bullets), a = count, de = bullets {x, y, angle, step}\n\n");
+    z80_print(f, p, Z80_SDAS);
+    fclose(f);
+    z80_free(p);
+    return true;
+}
@@ -0,0 +1,429 @@
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "generator.h"
+
+/*
+
+PATH_STEPS, PATH_ANGLES, DISTANCE and the aim_matrix size were picked by hand. --sweep builds the tables of every
+combination of them, with the three storages of PathAngleLUT (full, --fold=quadrant, --fold=octant), on all the
+cores, and prints the configurations nobody beats on all of:
+
+    bytes       the delta rows as stored, plus the aim table
+    miss        how far an aimed bullet passes from the player, in pixels, over enemy/player pairs of the whole
+                screen: the aim table, the angle count and the rounding of the rows all add to it
+    step        MSX T-states to move a bullet
+    aim         MSX T-states of an aimed shot
+
+The frontier goes to stdout as CSV, the summary to stderr. The path error (how far the repeated rows get from
+the true line after 256 pixels) is in the CSV too.
+
+The T-states are an estimate around what --bench measures for 16 steps, 128 angles and the 16x16 table:
+PathStep, PathStepFold and AimShot on the Z80 model. Each add hl,hl of the row address is 12 T-states more or
+less than the 5 of 16 steps. The octant mirror adds OCTANT_COST. The aim loop costs 40 + 18 per bit shifted,
+times the mean number of iterations measured on the same pairs, and a table over 16x16 needs a 16 bit index.
+
+Ranges are lists, --sweep=steps=4,8,16,32:angles=64,128:distance=1,2:aim=16,32. Steps must be powers of two (the
+step wraps with an and), angles multiples of 8 up to 256 (the octant fold, and the angle is a byte).
+
+*/
+
+#define SWEEP_MAX       16
+#define SWEEP_FLIGHT    256         // pixels flown for the path error
+#define SWEEP_TOLERANCE 1e-9
+#define OCTANT_COST     30          // mirror test and x/y swap of the octant fold, not measured
+#define ADD_COST        12          // add hl,hl with its M1 wait
+
+enum SWEEP_PARAMETERS {SWEEP_STEPS, SWEEP_ANGLES, SWEEP_DISTANCE, SWEEP_AIM, SWEEP_PARAMETERS};
+
+typedef struct SweepRange{
+    double  values[SWEEP_MAX];
+    int     count;
+}SweepRange;
+
+typedef struct SweepConfig{
+    int     steps, angles, aim, fold;
+    double  distance;
+    bool    valid, pareto;
+    int     bytes;
+    double  path_mean, path_max, miss_mean, miss_max, step, aim_cost;
+}SweepConfig;
+
+static const char *sweep_names[SWEEP_PARAMETERS]={"steps", "angles", "distance", "aim"};
+static const char *sweep_defaults[SWEEP_PARAMETERS]={"4,8,16,32", "32,64,96,128,192,256", "1,1.5,2,3,4", "8,16,32,64"};
+static const char *sweep_folds[]={"full", "quadrant", "octant"};
+static const int sweep_players[][2]={{128, 160}, {128, 96}, {16, 176}, {240, 8}};
+
+static SweepRange ranges[SWEEP_PARAMETERS];
+static SweepConfig *configs;
+static int nconfigs, next_base;
+static pthread_mutex_t sweep_lock=PTHREAD_MUTEX_INITIALIZER;
+
+// What --bench measures, and the mean aim loop iterations of the 16x16 table on the sweep pairs
+static double base_step, base_fold, base_aim, base_iterations;
+
+static bool sweep_parse_list(const char *list, size_t length, SweepRange *r){
+    r->count=0;
+    while(length){
+        size_t n=strcspn(list, ",");
+        char *end;
+        if(n>length)
+            n=length;
+        if(r->count==SWEEP_MAX)
+            return false;
+        r->values[r->count++]=strtod(list, &end);
+        if(end!=list+n)
+            return false;
+        list+=n;
+        length-=n;
+        if(length){
+            list++;
+            length--;
+        }
+    }
+    return r->count>0;
+}
+
+static bool sweep_power(int v){
+    return v>0 && !(v&(v-1));
+}
+
+// Reads the ranges, the defaults for the ones not given
+static bool sweep_parse(const char *text){
+    for(int p=0;p<SWEEP_PARAMETERS;p++)
+        sweep_parse_list(sweep_defaults[p], strlen(sweep_defaults[p]), &ranges[p]);
+    while(*text){
+        size_t length=strcspn(text, ":"), name;
+        int p;
+        for(p=0;p<SWEEP_PARAMETERS;p++){
+            name=strlen(sweep_names[p]);
+            if(length>name && !strncmp(text, sweep_names[p], name) && text[name]=='=')
+                break;
+        }
+        if(p==SWEEP_PARAMETERS || !sweep_parse_list(text+name+1, length-name-1, &ranges[p])){
+            fprintf(stderr, "sweep: %.*s is wrong, expected steps=, angles=, distance= or aim= and a list of up to %d numbers\n",
+                (int)length, text, SWEEP_MAX);
+            return false;
+        }
+        text+=length+(text[length]==':');
+    }
+    for(int i=0;i<ranges[SWEEP_STEPS].count;i++)
+        if(!sweep_power(ranges[SWEEP_STEPS].values[i]) || ranges[SWEEP_STEPS].values[i]>64){
+            fprintf(stderr, "sweep: steps must be powers of two up to 64\n");
+            return false;
+        }
+    for(int i=0;i<ranges[SWEEP_ANGLES].count;i++){
+        int angles=ranges[SWEEP_ANGLES].values[i];
+        if(angles!=ranges[SWEEP_ANGLES].values[i] || angles<8 || angles>256 || angles%8){
+            fprintf(stderr, "sweep: angles must be multiples of 8 up to 256\n");
+            return false;
+        }
+    }
+    for(int i=0;i<ranges[SWEEP_DISTANCE].count;i++)
+        if(ranges[SWEEP_DISTANCE].values[i]<0.25 || ranges[SWEEP_DISTANCE].values[i]>8){
+            fprintf(stderr, "sweep: the distance must be 0.25 to 8 pixels per step\n");
+            return false;
+        }
+    for(int i=0;i<ranges[SWEEP_AIM].count;i++)
+        if(!sweep_power(ranges[SWEEP_AIM].values[i]) || ranges[SWEEP_AIM].values[i]<4 || ranges[SWEEP_AIM].values[i]>64){
+            fprintf(stderr, "sweep: the aim table must be 4, 8, 16, 32 or 64\n");
+            return false;
+        }
+    return true;
+}
+
+// The aim of paths.c for any number of angles: the table gives the first quadrant angle, fixed up by the signs
+static int sweep_aim_angle(const uint8_t *table, int size, int angles, int dx, int dy, int *iterations){
+    int adx=abs(dx), ady=abs(dy), bits=aim_bits(size), quadrant=angles/4, angle, count=0;
+
+    while(adx>=size || ady>=size){
+        adx>>=bits;
+        ady>>=bits;
+        count++;
+    }
+    if(iterations)
+        *iterations=count;
+    angle=table[adx+size*ady];
+    if(dx<0)
+        return dy<0 ? 2*quadrant+angle : 2*quadrant-angle;
+    return dy<0 ? (4*quadrant-angle)%angles : angle;
+}
+
+static void sweep_aim_build(int size, int angles, uint8_t *table){
+    for(int dy=0;dy<size;dy++)
+        for(int dx=0;dx<size;dx++)
+            table[dx+size*dy]=dx || dy ? (int)(atan2(dy, dx)/(M_PI/2)*(angles/4)+0.5) : angles/4;
+}
+
+// True if every row of rows is the first quadrant one rotated, and the first octant mirrored when octant
+static bool sweep_folds_to(int (*rows)[2], int steps, int angles, bool octant){
+    int quadrant=angles/4;
+
+    for(int a=0;a<angles;a++)
+        for(int s=0;s<steps;s++){
+            int b=a%quadrant, x, y, dx, dy;
+            if(octant && b>quadrant/2){
+                x=rows[(quadrant-b)*steps+s][1];
+                y=rows[(quadrant-b)*steps+s][0];
+            }
+            else{
+                x=rows[b*steps+s][0];
+                y=rows[b*steps+s][1];
+            }
+            switch(a/quadrant){
+                case 0:  dx= x; dy= y; break;
+                case 1:  dx=-y; dy= x; break;
+                case 2:  dx=-x; dy=-y; break;
+                default: dx= y; dy=-x; break;
+            }
+            if(dx!=rows[a*steps+s][0] || dy!=rows[a*steps+s][1])
+                return false;
+        }
+    return true;
+}
+
+// Everything but the fold, for steps/angles/distance/aim, and the three storages
+static void sweep_measure(SweepConfig *c){
+    int steps=c->steps, angles=c->angles, size=c->aim, (*rows)[2]=malloc(angles*steps*sizeof(*rows));
+    uint8_t *table=malloc(size*size);
+    double path_total=0, miss_total=0, iterations=0, frames=ceil(SWEEP_FLIGHT/c->distance);
+    long pairs=0, count=0;
+
+    for(int a=0;a<angles;a++)
+        linear_row(a*2*M_PI/angles, c->distance, steps, rows+a*steps);
+    for(int a=0;a<angles;a++){
+        double radians=a*2*M_PI/angles;
+        int x=0, y=0;
+        for(int f=1;f<=frames;f++){
+            double e;
+            x+=rows[a*steps+(f-1)%steps][0];
+            y+=rows[a*steps+(f-1)%steps][1];
+            e=fmax(fabs(x-cos(radians)*c->distance*f), fabs(y-sin(radians)*c->distance*f));
+            c->path_max=fmax(c->path_max, e);
+            path_total+=e;
+            count++;
+        }
+    }
+    c->path_mean=path_total/count;
+
+    // aimed from every 16 pixels of the screen at the players of --bench, until the bullet is past the player
+    sweep_aim_build(size, angles, table);
+    for(int p=0;p<4;p++)
+        for(int ey=8;ey<192;ey+=16)
+            for(int ex=8;ex<256;ex+=16){
+                int dx=sweep_players[p][0]-ex, dy=sweep_players[p][1]-ey, n, a, x=0, y=0;
+                double distance=hypot(dx, dy), miss=distance;
+                if(distance<c->distance)
+                    continue;
+                a=sweep_aim_angle(table, size, angles, dx, dy, &n);
+                for(int f=1;f*c->distance<=distance+c->distance;f++){
+                    x+=rows[a*steps+(f-1)%steps][0];
+                    y+=rows[a*steps+(f-1)%steps][1];
+                    miss=fmin(miss, hypot(x-dx, y-dy));
+                }
+                c->miss_max=fmax(c->miss_max, miss);
+                miss_total+=miss;
+                iterations+=n;
+                pairs++;
+            }
+    c->miss_mean=miss_total/pairs;
+    iterations/=pairs;
+
+    {
+        int bits=aim_bits(size), adds=aim_bits(steps*2);
+        double loop=iterations*(40+18*bits)-base_iterations*(40+18*4);
+        // dy*size + dx: the 8 bit one adds A to itself, bits times, over 16x16 it takes a 16 bit add chain
+        double index=size<=16 ? (bits-4)*5 : ADD_COST*bits+10-4*5;
+        c->aim_cost=base_aim+loop+index;
+        c->step=base_step+(adds-5)*ADD_COST;
+    }
+    c->bytes=angles*steps*2+size*size;
+    c->valid=true;
+    for(int fold=FOLD_QUADRANT;fold<=FOLD_OCTANT;fold++){
+        SweepConfig *f=c+fold;
+        int rows_stored=fold==FOLD_QUADRANT ? angles/4 : angles/8+1;
+        *f=*c;
+        f->fold=fold;
+        f->valid=sweep_folds_to(rows, steps, angles, fold==FOLD_OCTANT);
+        f->bytes=rows_stored*steps*2+size*size;
+        f->step=c->step+base_fold+(fold==FOLD_OCTANT ? OCTANT_COST : 0);
+    }
+    free(rows);
+    free(table);
+}
+
+// Takes the next steps/angles/distance/aim until there are none left
+static void *sweep_worker(void *unused){
+    (void)unused;
+    for(;;){
+        int base;
+        pthread_mutex_lock(&sweep_lock);
+        base=next_base;
+        next_base+=3;
+        pthread_mutex_unlock(&sweep_lock);
+        if(base>=nconfigs)
+            return NULL;
+        sweep_measure(&configs[base]);
+    }
+}
+
+// a is at least as good as b on everything and better on something
+static bool sweep_dominates(const SweepConfig *a, const SweepConfig *b){
+    if(a->bytes>b->bytes || a->miss_mean>b->miss_mean+SWEEP_TOLERANCE || a->step>b->step+SWEEP_TOLERANCE ||
+        a->aim_cost>b->aim_cost+SWEEP_TOLERANCE)
+        return false;
+    return a->bytes<b->bytes || a->miss_mean<b->miss_mean-SWEEP_TOLERANCE || a->step<b->step-SWEEP_TOLERANCE ||
+        a->aim_cost<b->aim_cost-SWEEP_TOLERANCE;
+}
+
+static int sweep_compare(const void *a, const void *b){
+    const SweepConfig *x=*(SweepConfig * const *)a, *y=*(SweepConfig * const *)b;
+
+    if(x->bytes!=y->bytes)
+        return x->bytes-y->bytes;
+    return (x->miss_mean>y->miss_mean)-(x->miss_mean<y->miss_mean);
+}
+
+static void sweep_describe(const char *what, const SweepConfig *c){
+    if(!c){
+        fprintf(stderr, "sweep: %-34s none\n", what);
+        return;
+    }
+    fprintf(stderr, "sweep: %-34s %2d steps, %3d angles, distance %-4g %2dx%-2d aim, %-8s %5d bytes, miss %.2f px, step %.0f, aim %.0f\n",
+        what, c->steps, c->angles, c->distance, c->aim, c->aim, sweep_folds[c->fold], c->bytes, c->miss_mean, c->step, c->aim_cost);
+}
+
+// Calibrates the estimates with --bench and the 16x16 aim loop on the sweep pairs
+static bool sweep_calibrate(void){
+    uint8_t table[256];
+    long runs=0, pairs=0;
+
+    if(!bench_open()){
+        bench_close();
+        return false;
+    }
+    base_step=base_fold=base_aim=base_iterations=0;
+    for(int a=0;a<PATH_ANGLES;a++)
+        for(int s=0;s<PATH_STEPS;s++){
+            base_step+=bench_step_call(0, a, s).msx;
+            base_fold+=bench_step_call(1, a, s).msx;
+            runs++;
+        }
+    base_fold=(base_fold-base_step)/runs;
+    base_step/=runs;
+    aim_build(16, table);
+    for(int p=0;p<4;p++)
+        for(int ey=8;ey<192;ey+=16)
+            for(int ex=8;ex<256;ex+=16){
+                int n;
+                base_aim+=bench_aim_call(0, ex, ey, sweep_players[p][0], sweep_players[p][1]).msx;
+                aim_angle(table, 16, 4, sweep_players[p][0]-ex, sweep_players[p][1]-ey, &n);
+                base_iterations+=n;
+                pairs++;
+            }
+    base_aim/=pairs;
+    base_iterations/=pairs;
+    bench_close();
+    return true;
+}
+
+// Runs the sweep and prints the Pareto frontier as CSV, and the summary on stderr
+bool sweep_report(const char *text){
+    int threads=sysconf(_SC_NPROCESSORS_ONLN), valid=0, nfrontier=0, current=-1;
+    pthread_t *workers;
+    SweepConfig **frontier;
+    const SweepConfig *smallest=NULL, *accurate=NULL, *fastest=NULL, *better=NULL;
+    struct timespec start, end;
+
+    if(!sweep_parse(text) || !sweep_calibrate())
+        return false;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    nconfigs=3;
+    for(int p=0;p<SWEEP_PARAMETERS;p++)
+        nconfigs*=ranges[p].count;
+    configs=calloc(nconfigs, sizeof(*configs));
+    {
+        int i=0;
+        for(int s=0;s<ranges[SWEEP_STEPS].count;s++)
+            for(int a=0;a<ranges[SWEEP_ANGLES].count;a++)
+                for(int d=0;d<ranges[SWEEP_DISTANCE].count;d++)
+                    for(int m=0;m<ranges[SWEEP_AIM].count;m++,i+=3){
+                        configs[i].steps=ranges[SWEEP_STEPS].values[s];
+                        configs[i].angles=ranges[SWEEP_ANGLES].values[a];
+                        configs[i].distance=ranges[SWEEP_DISTANCE].values[d];
+                        configs[i].aim=ranges[SWEEP_AIM].values[m];
+                        configs[i].fold=FOLD_NONE;
+                    }
+    }
+    if(threads<1)
+        threads=1;
+    next_base=0;
+    workers=malloc(threads*sizeof(*workers));
+    for(int t=0;t<threads;t++)
+        pthread_create(&workers[t], NULL, sweep_worker, NULL);
+    for(int t=0;t<threads;t++)
+        pthread_join(workers[t], NULL);
+    free(workers);
+
+    frontier=malloc(nconfigs*sizeof(*frontier));
+    for(int i=0;i<nconfigs;i++){
+        SweepConfig *c=&configs[i];
+        if(!c->valid)
+            continue;
+        valid++;
+        c->pareto=true;
+        for(int j=0;j<nconfigs && c->pareto;j++)
+            c->pareto=!(configs[j].valid && sweep_dominates(&configs[j], c));
+        if(c->pareto)
+            frontier[nfrontier++]=c;
+        if(c->steps==PATH_STEPS && c->angles==PATH_ANGLES && c->distance==DISTANCE && c->aim==16 && c->fold==FOLD_NONE)
+            current=i;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    qsort(frontier, nfrontier, sizeof(*frontier), sweep_compare);
+
+    printf("steps,angles,distance,aim,fold,bytes,miss_mean,miss_max,path_mean,path_max,step_tstates,aim_tstates\n");
+    for(int i=0;i<nfrontier;i++){
+        const SweepConfig *c=frontier[i];
+        printf("%d,%d,%g,%d,%s,%d,%.3f,%.3f,%.3f,%.3f,%.0f,%.0f\n", c->steps, c->angles, c->distance, c->aim, sweep_folds[c->fold],
+            c->bytes, c->miss_mean, c->miss_max, c->path_mean, c->path_max, c->step, c->aim_cost);
+    }
+
+    fprintf(stderr, "sweep: %d configurations (%d fold that way) on %d threads in %.2f s, %d on the Pareto frontier\n",
+        nconfigs, valid, threads, (end.tv_sec-start.tv_sec)+(end.tv_nsec-start.tv_nsec)/1e9, nfrontier);
+    fprintf(stderr, "sweep: bytes, miss, step and aim are minimized, the T-states are estimates (see the top of sweep.c)\n");
+    if(current>=0){
+        const SweepConfig *c=&configs[current];
+        sweep_describe("today", c);
+        // the distance is the speed of the bullets, a game design choice, so the picks keep it
+        for(int i=0;i<nconfigs;i++){
+            const SweepConfig *f=&configs[i];
+            if(!f->valid || f->distance!=c->distance || f==c)
+                continue;
+            if(f->bytes<c->bytes && f->miss_mean<=c->miss_mean && f->step<=c->step && f->aim_cost<=c->aim_cost && (!smallest || f->bytes<smallest->bytes))
+                smallest=f;
+            if(f->miss_mean<c->miss_mean && f->bytes<=c->bytes && f->step<=c->step && f->aim_cost<=c->aim_cost && (!accurate || f->miss_mean<accurate->miss_mean))
+                accurate=f;
+            if(f->step<c->step && f->bytes<=c->bytes && f->miss_mean<=c->miss_mean && f->aim_cost<=c->aim_cost && (!fastest || f->step<fastest->step))
+                fastest=f;
+            if(sweep_dominates(f, c) && (!better || f->bytes<better->bytes))
+                better=f;
+        }
+        fprintf(stderr, "sweep: today is %s, picks at distance %g:\n", c->pareto ? "on the frontier" : better ? "dominated" :
+            "dominated by other distances only", c->distance);
+        sweep_describe("smaller, as accurate and fast", smallest);
+        sweep_describe("more accurate, as small and fast", accurate);
+        sweep_describe("faster step, as small and accurate", fastest);
+        sweep_describe("smallest that beats it", better);
+    }
+    else{
+        sweep_describe("smallest", nfrontier ? frontier[0] : NULL);
+        sweep_describe("largest", nfrontier ? frontier[nfrontier-1] : NULL);
+    }
+    free(frontier);
+    free(configs);
+    return true;
+}
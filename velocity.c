@@ -0,0 +1,98 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "generator.h"
+
+/*
+
+Velocity tables: instead of 16 integer deltas per angle, one signed 8.8 fixed point (vx, vy) per angle and speed,
+added every frame to an 8.8 position. The fraction is kept, so a bullet follows the true line for as long as it
+lives, and any speed costs 512 bytes (128 angles * 2 axes * 2 bytes).
+
+The delta tables repeat every PATH_STEPS frames, and the rounding error of the last step of a row is repeated
+with it: the drift report shows how far each mode gets from the true line in 256 frames.
+
+*/
+
+#define DRIFT_FRAMES    256
+
+// 8.8 velocity of an angle index at speed pixels per frame
+int velocity_value(double speed, int angle, int axis){
+    double a=angle*2*M_PI/PATH_ANGLES;
+
+    return lround((axis ? sin(a) : cos(a))*speed*256);
+}
+
+typedef struct Drift{
+    double  max, total, end;
+    long    count;
+}Drift;
+
+static void drift_add(Drift *d, double error, int frame){
+    error=fabs(error);
+    if(error>d->max)
+        d->max=error;
+    if(frame==DRIFT_FRAMES && error>d->end)
+        d->end=error;
+    d->total+=error;
+    d->count++;
+}
+
+// Compares the delta table and the 8.8 velocity of every speed with the true line, on stderr
+void velocity_report(const double *speeds, int count){
+    int (*row)[2]=malloc(PATH_STEPS*sizeof(*row));
+
+    fprintf(stderr, "velocity: pixel error against true trig over %d frames, all angles\n", DRIFT_FRAMES);
+    fprintf(stderr, "velocity: %6s   %-30s %-30s\n", "speed", "delta table (repeats)", "8.8 velocity");
+    fprintf(stderr, "velocity: %6s   %8s %8s %8s     %8s %8s %8s\n", "", "max", "mean", "frame256", "max", "mean", "frame256");
+    for(int s=0;s<count;s++){
+        Drift delta={0}, fixed={0};
+        for(int i=0;i<PATH_ANGLES;i++){
+            double a=i*2*M_PI/PATH_ANGLES;
+            int px=0, py=0;
+            long fx=0x80, fy=0x80;
+            int vx=velocity_value(speeds[s], i, 0), vy=velocity_value(speeds[s], i, 1);
+            linear_row(a, speeds[s], PATH_STEPS, row);
+            for(int frame=1;frame<=DRIFT_FRAMES;frame++){
+                double tx=cos(a)*speeds[s]*frame, ty=sin(a)*speeds[s]*frame;
+                px+=row[(frame-1)%PATH_STEPS][0];
+                py+=row[(frame-1)%PATH_STEPS][1];
+                fx+=vx;
+                fy+=vy;
+                drift_add(&delta, fmax(fabs(px-tx), fabs(py-ty)), frame);
+                // the pixel is the high byte: a floor, also for negative positions
+                drift_add(&fixed, fmax(fabs((fx>>8)-tx), fabs((fy>>8)-ty)), frame);
+            }
+        }
+        fprintf(stderr, "velocity: %6g   %8.2f %8.2f %8.2f     %8.2f %8.2f %8.2f\n", speeds[s], delta.max, delta.total/delta.count,
+            delta.end, fixed.max, fixed.total/fixed.count, fixed.end);
+    }
+    free(row);
+}
+
+// Prints the velocity tables and the SDCC routine that steps an 8.8 position with them
+void velocity_print(const double *speeds, int count){
+    int shape[3]={count, PATH_ANGLES, 2}, *values=malloc(count*PATH_ANGLES*2*sizeof(int));
+    char name[32];
+
+    for(int s=0;s<count;s++)
+        for(int i=0;i<PATH_ANGLES;i++)
+            for(int axis=0;axis<2;axis++)
+                values[(s*PATH_ANGLES+i)*2+axis]=velocity_value(speeds[s], i, axis);
+    printf("// 8.8 fixed point velocities, PathVelocity[speed][angle] = (vx, vy), speeds in pixels per frame\n");
+    printf("#define PATH_SPEEDS %d\n", count);
+    for(int s=0;s<count;s++){
+        speed_name(speeds[s], name, sizeof(name));
+        printf("#define PATH_SPEED_%s %d\n", name, s);
+    }
+    emit_table("i16", "PathVelocity", "[PATH_SPEEDS][PATH_ANGLES][2]", values, shape, 3);
+    free(values);
+
+    printf("// Positions are 8.8 too, the high byte is the pixel. Spawn with the low byte at 0x80, the middle of the\n");
+    printf("// pixel, so the high byte is always the rounded position\n");
+    printf("static void PathVelocityStep(u16 *x, u16 *y, u8 speed, u8 angle){\n");
+    printf("    const i16 *v = PathVelocity[speed][angle];\n");
+    printf("    *x += v[0];\n");
+    printf("    *y += v[1];\n");
+    printf("}\n\n");
+}
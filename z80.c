@@ -0,0 +1,560 @@
+#include <stdlib.h>
+#include <string.h>
+#include "z80.h"
+
+#define Z80_MAX_INSTRUCTIONS    50000000L   // a routine running longer than this is stuck in a loop
+#define Z80_MAX_DEPTH           64
+
+static const char *reg_names[8]={"b", "c", "d", "e", "h", "l", "(hl)", "a"};
+static const char *pair_names[5]={"bc", "de", "hl", "sp", "af"};
+static const char *cond_names[9]={"nz", "z", "nc", "c", "po", "pe", "p", "m", ""};
+static const char *alu_names[8]={"add a,", "adc a,", "sub ", "sbc a,", "and ", "xor ", "or ", "cp "};
+static const char *shift_names[8]={"rlc", "rrc", "rl", "rr", "sla", "sra", "sll", "srl"};
+
+Z80Program *z80_new(const char *name){
+    Z80Program *p=calloc(1, sizeof(Z80Program));
+
+    p->name=name;
+    return p;
+}
+
+void z80_free(Z80Program *p){
+    free(p->ops);
+    free(p);
+}
+
+void z80_op(Z80Program *p, int op, int x, int y, int32_t n, const char *sym){
+    if(p->count==p->size){
+        p->size=p->size ? p->size*2 : 64;
+        p->ops=realloc(p->ops, p->size*sizeof(Z80Op));
+    }
+    p->ops[p->count++]=(Z80Op){op, x, y, n, sym, n};
+}
+
+void z80_symbol(Z80 *cpu, const char *name, uint16_t addr){
+    for(int i=0;i<cpu->nsymbols;i++)
+        if(!strcmp(cpu->symbols[i].name, name)){
+            cpu->symbols[i].addr=addr;
+            return;
+        }
+    if(cpu->nsymbols==Z80_MAX_SYMBOLS){
+        fprintf(stderr, "z80: too many symbols, %s dropped\n", name);
+        return;
+    }
+    cpu->symbols[cpu->nsymbols++]=(Z80Symbol){name, addr};
+}
+
+// Copies a table to the memory and names it
+void z80_load(Z80 *cpu, const char *name, uint16_t addr, const uint8_t *data, int size){
+    memcpy(cpu->mem+addr, data, size);
+    z80_symbol(cpu, name, addr);
+}
+
+static bool is_jump(int op){
+    return op==OP_JP || op==OP_JR || op==OP_DJNZ || op==OP_CALL;
+}
+
+// Resolves the labels of the jumps and the symbols of the memory accesses. Must be called again if a symbol moves
+bool z80_link(Z80 *cpu, Z80Program *p){
+    for(int i=0;i<p->count;i++){
+        Z80Op *o=&p->ops[i];
+        bool found=false;
+
+        if(o->op==OP_LABEL || !o->sym){
+            o->target=o->n;
+            continue;
+        }
+        if(is_jump(o->op)){
+            for(int j=0;j<p->count && !found;j++)
+                if(p->ops[j].op==OP_LABEL && !strcmp(p->ops[j].sym, o->sym)){
+                    o->target=j;
+                    found=true;
+                }
+        }
+        else{
+            for(int j=0;j<cpu->nsymbols && !found;j++)
+                if(!strcmp(cpu->symbols[j].name, o->sym)){
+                    o->target=(cpu->symbols[j].addr+o->n)&0xFFFF;
+                    found=true;
+                }
+        }
+        if(!found){
+            fprintf(stderr, "z80: %s: unknown %s %s\n", p->name, is_jump(o->op) ? "label" : "symbol", o->sym);
+            return false;
+        }
+    }
+    return true;
+}
+
+uint16_t z80_pair(const Z80 *cpu, int rp){
+    switch(rp){
+        case RP_BC: return cpu->r[R_B]<<8 | cpu->r[R_C];
+        case RP_DE: return cpu->r[R_D]<<8 | cpu->r[R_E];
+        case RP_HL: return cpu->r[R_H]<<8 | cpu->r[R_L];
+        case RP_SP: return cpu->sp;
+        default:    return cpu->r[R_A]<<8 | cpu->f;
+    }
+}
+
+void z80_set_pair(Z80 *cpu, int rp, uint16_t v){
+    switch(rp){
+        case RP_BC: cpu->r[R_B]=v>>8; cpu->r[R_C]=v; break;
+        case RP_DE: cpu->r[R_D]=v>>8; cpu->r[R_E]=v; break;
+        case RP_HL: cpu->r[R_H]=v>>8; cpu->r[R_L]=v; break;
+        case RP_SP: cpu->sp=v; break;
+        default:    cpu->r[R_A]=v>>8; cpu->f=v; break;
+    }
+}
+
+static uint8_t rd(Z80 *cpu, uint16_t addr){
+    cpu->reads++;
+    if(addr>=cpu->watch_start && addr<cpu->watch_end)
+        cpu->watched++;
+    return cpu->mem[addr];
+}
+
+static void wr(Z80 *cpu, uint16_t addr, uint8_t v){
+    cpu->writes++;
+    cpu->mem[addr]=v;
+}
+
+static uint8_t get(Z80 *cpu, int r){
+    return r==R_HLI ? rd(cpu, z80_pair(cpu, RP_HL)) : cpu->r[r];
+}
+
+static void put(Z80 *cpu, int r, uint8_t v){
+    if(r==R_HLI)
+        wr(cpu, z80_pair(cpu, RP_HL), v);
+    else
+        cpu->r[r]=v;
+}
+
+static uint8_t parity(uint8_t v){
+    v^=v>>4;
+    v^=v>>2;
+    v^=v>>1;
+    return (v&1) ? 0 : Z80_FLAG_PV;
+}
+
+static uint8_t sz(uint8_t v){
+    return (v&0x80) | (v ? 0 : Z80_FLAG_Z);
+}
+
+static void alu(Z80 *cpu, int aop, uint8_t v){
+    uint8_t a=cpu->r[R_A], c=cpu->f&Z80_FLAG_C;
+    int r;
+
+    switch(aop){
+        case ALU_ADD:
+        case ALU_ADC:
+            r=a+v+(aop==ALU_ADC ? c : 0);
+            cpu->f=sz(r) | (r>0xFF ? Z80_FLAG_C : 0) | ((~(a^v)&(a^r)&0x80) ? Z80_FLAG_PV : 0);
+            cpu->r[R_A]=r;
+            break;
+        case ALU_SUB:
+        case ALU_SBC:
+        case ALU_CP:
+            r=a-v-(aop==ALU_SBC ? c : 0);
+            cpu->f=sz(r) | (r<0 ? Z80_FLAG_C : 0) | (((a^v)&(a^r)&0x80) ? Z80_FLAG_PV : 0);
+            if(aop!=ALU_CP)
+                cpu->r[R_A]=r;
+            break;
+        default:
+            if(aop==ALU_AND)
+                a&=v;
+            else if(aop==ALU_XOR)
+                a^=v;
+            else
+                a|=v;
+            cpu->f=sz(a) | parity(a);
+            cpu->r[R_A]=a;
+            break;
+    }
+}
+
+static uint8_t shift(Z80 *cpu, int sop, uint8_t v){
+    uint8_t c=cpu->f&Z80_FLAG_C, out, r;
+
+    switch(sop){
+        case SH_RLC: out=v>>7; r=v<<1 | out; break;
+        case SH_RRC: out=v&1;  r=v>>1 | out<<7; break;
+        case SH_RL:  out=v>>7; r=v<<1 | c; break;
+        case SH_RR:  out=v&1;  r=v>>1 | c<<7; break;
+        case SH_SLA: out=v>>7; r=v<<1; break;
+        case SH_SRA: out=v&1;  r=(v>>1) | (v&0x80); break;
+        case SH_SLL: out=v>>7; r=v<<1 | 1; break;
+        default:     out=v&1;  r=v>>1; break;
+    }
+    cpu->f=sz(r) | parity(r) | out;
+    return r;
+}
+
+static bool cond(const Z80 *cpu, int cc){
+    switch(cc){
+        case CC_NZ: return !(cpu->f&Z80_FLAG_Z);
+        case CC_Z:  return cpu->f&Z80_FLAG_Z;
+        case CC_NC: return !(cpu->f&Z80_FLAG_C);
+        case CC_C:  return cpu->f&Z80_FLAG_C;
+        case CC_PO: return !(cpu->f&Z80_FLAG_PV);
+        case CC_PE: return cpu->f&Z80_FLAG_PV;
+        case CC_P:  return !(cpu->f&Z80_FLAG_S);
+        case CC_M:  return cpu->f&Z80_FLAG_S;
+        default:    return true;
+    }
+}
+
+static void push16(Z80 *cpu, uint16_t v){
+    cpu->sp-=2;
+    wr(cpu, cpu->sp, v);
+    wr(cpu, cpu->sp+1, v>>8);
+}
+
+static uint16_t pop16(Z80 *cpu){
+    uint16_t v=rd(cpu, cpu->sp) | rd(cpu, cpu->sp+1)<<8;
+
+    cpu->sp+=2;
+    return v;
+}
+
+// Runs the routine until its final RET and returns the T-states it took (without the CALL to it). The MSX wait
+// states are in cpu->m1. z80_link() must have been called before
+long z80_call(Z80 *cpu, Z80Program *p){
+    int pc=0, depth=0, stack[Z80_MAX_DEPTH];
+    long start=cpu->tstates, count=0;
+
+    while(pc<p->count){
+        Z80Op *o=&p->ops[pc++];
+        int t=0, m1=1, v;
+        uint16_t hl=z80_pair(cpu, RP_HL);
+
+        if(++count>Z80_MAX_INSTRUCTIONS){
+            fprintf(stderr, "z80: %s doesn't return\n", p->name);
+            exit(1);
+        }
+        switch(o->op){
+            case OP_LABEL: m1=0; break;
+            case OP_NOP:  t=4; break;
+            case OP_LD:
+                put(cpu, o->x, get(cpu, o->y));
+                t=(o->x==R_HLI || o->y==R_HLI) ? 7 : 4;
+                break;
+            case OP_LDN:
+                put(cpu, o->x, o->target);
+                t=o->x==R_HLI ? 10 : 7;
+                break;
+            case OP_LD16:    z80_set_pair(cpu, o->x, o->target); t=10; break;
+            case OP_LDA_MEM: cpu->r[R_A]=rd(cpu, o->target); t=13; break;
+            case OP_LDMEM_A: wr(cpu, o->target, cpu->r[R_A]); t=13; break;
+            case OP_LDA_RP:  cpu->r[R_A]=rd(cpu, z80_pair(cpu, o->x)); t=7; break;
+            case OP_LDRP_A:  wr(cpu, z80_pair(cpu, o->x), cpu->r[R_A]); t=7; break;
+            case OP_LDHL_MEM:
+                z80_set_pair(cpu, RP_HL, rd(cpu, o->target) | rd(cpu, (o->target+1)&0xFFFF)<<8);
+                t=16;
+                break;
+            case OP_LDMEM_HL:
+                wr(cpu, o->target, cpu->r[R_L]);
+                wr(cpu, (o->target+1)&0xFFFF, cpu->r[R_H]);
+                t=16;
+                break;
+            case OP_LDSP_HL: cpu->sp=hl; t=6; break;
+            case OP_ALU:
+                alu(cpu, o->x, get(cpu, o->y));
+                t=o->y==R_HLI ? 7 : 4;
+                break;
+            case OP_ALUN: alu(cpu, o->x, o->target); t=7; break;
+            case OP_INC:
+            case OP_DEC:
+                v=get(cpu, o->x);
+                v=(v+(o->op==OP_INC ? 1 : -1))&0xFF;
+                put(cpu, o->x, v);
+                cpu->f=(cpu->f&Z80_FLAG_C) | sz(v) | (v==(o->op==OP_INC ? 0x80 : 0x7F) ? Z80_FLAG_PV : 0);
+                t=o->x==R_HLI ? 11 : 4;
+                break;
+            case OP_INC16: z80_set_pair(cpu, o->x, z80_pair(cpu, o->x)+1); t=6; break;
+            case OP_DEC16: z80_set_pair(cpu, o->x, z80_pair(cpu, o->x)-1); t=6; break;
+            case OP_ADD16:
+                v=hl+z80_pair(cpu, o->x);
+                cpu->f=(cpu->f&~Z80_FLAG_C) | (v>0xFFFF ? Z80_FLAG_C : 0);
+                z80_set_pair(cpu, RP_HL, v);
+                t=11;
+                break;
+            case OP_ADC16:
+            case OP_SBC16:{
+                int rr=z80_pair(cpu, o->x), c=cpu->f&Z80_FLAG_C, ov;
+                if(o->op==OP_ADC16){
+                    v=hl+rr+c;
+                    ov=~(hl^rr)&(hl^v)&0x8000;
+                }
+                else{
+                    v=hl-rr-c;
+                    ov=(hl^rr)&(hl^v)&0x8000;
+                }
+                cpu->f=((v>>8)&0x80) | ((v&0xFFFF) ? 0 : Z80_FLAG_Z) | (ov ? Z80_FLAG_PV : 0) | ((v<0 || v>0xFFFF) ? Z80_FLAG_C : 0);
+                z80_set_pair(cpu, RP_HL, v);
+                t=15;
+                m1=2;
+                break;
+            }
+            case OP_SHIFT:
+                put(cpu, o->y, shift(cpu, o->x, get(cpu, o->y)));
+                t=o->y==R_HLI ? 15 : 8;
+                m1=2;
+                break;
+            case OP_BIT:
+                cpu->f=(cpu->f&Z80_FLAG_C) | ((get(cpu, o->y)>>o->x)&1 ? 0 : Z80_FLAG_Z|Z80_FLAG_PV);
+                t=o->y==R_HLI ? 12 : 8;
+                m1=2;
+                break;
+            case OP_SET:
+            case OP_RES:
+                v=get(cpu, o->y);
+                put(cpu, o->y, o->op==OP_SET ? v|(1<<o->x) : v&~(1<<o->x));
+                t=o->y==R_HLI ? 15 : 8;
+                m1=2;
+                break;
+            case OP_RLCA:
+            case OP_RRCA:
+            case OP_RLA:
+            case OP_RRA:{
+                uint8_t a=cpu->r[R_A], c=cpu->f&Z80_FLAG_C, out;
+                if(o->op==OP_RLCA || o->op==OP_RLA){
+                    out=a>>7;
+                    a=a<<1 | (o->op==OP_RLCA ? out : c);
+                }
+                else{
+                    out=a&1;
+                    a=a>>1 | (o->op==OP_RRCA ? out : c)<<7;
+                }
+                cpu->r[R_A]=a;
+                cpu->f=(cpu->f&~Z80_FLAG_C) | out;
+                t=4;
+                break;
+            }
+            case OP_CPL: cpu->r[R_A]=~cpu->r[R_A]; t=4; break;
+            case OP_NEG:
+                v=cpu->r[R_A];
+                cpu->r[R_A]=0;
+                alu(cpu, ALU_SUB, v);
+                t=8;
+                m1=2;
+                break;
+            case OP_SCF: cpu->f|=Z80_FLAG_C; t=4; break;
+            case OP_CCF: cpu->f^=Z80_FLAG_C; t=4; break;
+            case OP_JP:
+                if(cond(cpu, o->x))
+                    pc=o->target;
+                t=10;
+                break;
+            case OP_JPHL:
+                fprintf(stderr, "z80: %s: JP (HL) can't leave the routine\n", p->name);
+                exit(1);
+            case OP_JR:
+                t=7;
+                if(cond(cpu, o->x)){
+                    pc=o->target;
+                    t=12;
+                }
+                break;
+            case OP_DJNZ:
+                t=8;
+                if(--cpu->r[R_B]){
+                    pc=o->target;
+                    t=13;
+                }
+                break;
+            case OP_CALL:
+                t=10;
+                if(cond(cpu, o->x)){
+                    if(depth==Z80_MAX_DEPTH){
+                        fprintf(stderr, "z80: %s: calls nested too deep\n", p->name);
+                        exit(1);
+                    }
+                    push16(cpu, 0);
+                    stack[depth++]=pc;
+                    pc=o->target;
+                    t=17;
+                }
+                break;
+            case OP_RET:
+                t=o->x==CC_ALWAYS ? 10 : 5;
+                if(cond(cpu, o->x)){
+                    if(o->x!=CC_ALWAYS)
+                        t=11;
+                    if(!depth){
+                        cpu->tstates+=t;
+                        cpu->m1++;
+                        return cpu->tstates-start;
+                    }
+                    pop16(cpu);
+                    pc=stack[--depth];
+                }
+                break;
+            case OP_PUSH: push16(cpu, z80_pair(cpu, o->x)); t=11; break;
+            case OP_POP:  z80_set_pair(cpu, o->x, pop16(cpu)); t=10; break;
+            case OP_EXDEHL:{
+                uint16_t de=z80_pair(cpu, RP_DE);
+                z80_set_pair(cpu, RP_DE, hl);
+                z80_set_pair(cpu, RP_HL, de);
+                t=4;
+                break;
+            }
+            case OP_EXSPHL:{
+                uint16_t v=pop16(cpu);
+                push16(cpu, hl);
+                z80_set_pair(cpu, RP_HL, v);
+                t=19;
+                break;
+            }
+            case OP_EXAF:{
+                uint8_t a=cpu->r[R_A], f=cpu->f;
+                cpu->r[R_A]=cpu->a2;
+                cpu->f=cpu->f2;
+                cpu->a2=a;
+                cpu->f2=f;
+                t=4;
+                break;
+            }
+            case OP_LDI:
+            case OP_LDIR:{
+                uint16_t de=z80_pair(cpu, RP_DE), bc=z80_pair(cpu, RP_BC);
+                do{
+                    wr(cpu, de++, rd(cpu, hl++));
+                    bc--;
+                    t+=(o->op==OP_LDIR && bc) ? 21 : 16;
+                    cpu->m1+=2;
+                }while(o->op==OP_LDIR && bc);
+                z80_set_pair(cpu, RP_DE, de);
+                z80_set_pair(cpu, RP_HL, hl);
+                z80_set_pair(cpu, RP_BC, bc);
+                cpu->f=(cpu->f&~Z80_FLAG_PV) | (bc ? Z80_FLAG_PV : 0);
+                m1=0;
+                break;
+            }
+        }
+        cpu->tstates+=t;
+        cpu->m1+=m1;
+    }
+    fprintf(stderr, "z80: %s runs past its end\n", p->name);
+    exit(1);
+}
+
+static int op_size(const Z80Op *o){
+    switch(o->op){
+        case OP_LABEL:
+            return 0;
+        case OP_LDN: case OP_ALUN: case OP_JR: case OP_DJNZ:
+        case OP_SHIFT: case OP_BIT: case OP_SET: case OP_RES: case OP_NEG:
+        case OP_ADC16: case OP_SBC16: case OP_LDI: case OP_LDIR:
+            return 2;
+        case OP_LD16: case OP_LDA_MEM: case OP_LDMEM_A: case OP_LDHL_MEM: case OP_LDMEM_HL:
+        case OP_JP: case OP_CALL:
+            return 3;
+        default:
+            return 1;
+    }
+}
+
+// Size of the routine in bytes
+int z80_size(const Z80Program *p){
+    int size=0;
+
+    for(int i=0;i<p->count;i++)
+        size+=op_size(&p->ops[i]);
+    return size;
+}
+
+// Prints a memory operand or an immediate, which sdasz80 wants with a #: a symbol plus offset, or a number
+static void print_value(FILE *f, const Z80Op *o, int syntax, bool immediate){
+    if(syntax==Z80_SDAS && immediate)
+        fprintf(f, "#");
+    if(o->sym && o->n)
+        fprintf(f, "%s%+d", o->sym, o->n);
+    else if(o->sym)
+        fprintf(f, "%s", o->sym);
+    else
+        fprintf(f, "%d", o->n);
+}
+
+// A label of the routine, or nnnn$ for sdasz80: local labels of the routine name, numbered from 1 in order
+static void print_label(FILE *f, const Z80Program *p, const char *label, int syntax){
+    for(int i=0, n=0;i<p->count && syntax==Z80_SDAS;i++)
+        if(p->ops[i].op==OP_LABEL && (n++, !strcmp(p->ops[i].sym, label))){
+            fprintf(f, "%d$", n);
+            return;
+        }
+    fprintf(f, "%s", label);
+}
+
+static void print_jump(FILE *f, const Z80Program *p, const char *mnemonic, const Z80Op *o, int syntax){
+    if(o->x==CC_ALWAYS)
+        fprintf(f, "%s ", mnemonic);
+    else
+        fprintf(f, "%s %s,", mnemonic, cond_names[o->x]);
+    print_label(f, p, o->sym, syntax);
+}
+
+// Prints the routine as sjasm/z80asm source, or as an sdasz80 module exporting it
+void z80_print(FILE *f, const Z80Program *p, int syntax){
+    if(syntax==Z80_SDAS)
+        fprintf(f, "        .globl %s\n        .area _CODE\n\n", p->name);
+    fprintf(f, "%s:\n", p->name);
+    for(int i=0;i<p->count;i++){
+        const Z80Op *o=&p->ops[i];
+
+        if(o->op==OP_LABEL){
+            print_label(f, p, o->sym, syntax);
+            fprintf(f, ":\n");
+            continue;
+        }
+        fprintf(f, "        ");
+        switch(o->op){
+            case OP_NOP:        fprintf(f, "nop"); break;
+            case OP_LD:         fprintf(f, "ld %s,%s", reg_names[o->x], reg_names[o->y]); break;
+            case OP_LDN:        fprintf(f, "ld %s,", reg_names[o->x]); print_value(f, o, syntax, true); break;
+            case OP_LD16:       fprintf(f, "ld %s,", pair_names[o->x]); print_value(f, o, syntax, true); break;
+            case OP_LDA_MEM:    fprintf(f, "ld a,("); print_value(f, o, syntax, false); fprintf(f, ")"); break;
+            case OP_LDMEM_A:    fprintf(f, "ld ("); print_value(f, o, syntax, false); fprintf(f, "),a"); break;
+            case OP_LDA_RP:     fprintf(f, "ld a,(%s)", pair_names[o->x]); break;
+            case OP_LDRP_A:     fprintf(f, "ld (%s),a", pair_names[o->x]); break;
+            case OP_LDHL_MEM:   fprintf(f, "ld hl,("); print_value(f, o, syntax, false); fprintf(f, ")"); break;
+            case OP_LDMEM_HL:   fprintf(f, "ld ("); print_value(f, o, syntax, false); fprintf(f, "),hl"); break;
+            case OP_LDSP_HL:    fprintf(f, "ld sp,hl"); break;
+            case OP_ALU:        fprintf(f, "%s%s", alu_names[o->x], reg_names[o->y]); break;
+            case OP_ALUN:       fprintf(f, "%s", alu_names[o->x]); print_value(f, o, syntax, true); break;
+            case OP_INC:        fprintf(f, "inc %s", reg_names[o->x]); break;
+            case OP_DEC:        fprintf(f, "dec %s", reg_names[o->x]); break;
+            case OP_INC16:      fprintf(f, "inc %s", pair_names[o->x]); break;
+            case OP_DEC16:      fprintf(f, "dec %s", pair_names[o->x]); break;
+            case OP_ADD16:      fprintf(f, "add hl,%s", pair_names[o->x]); break;
+            case OP_ADC16:      fprintf(f, "adc hl,%s", pair_names[o->x]); break;
+            case OP_SBC16:      fprintf(f, "sbc hl,%s", pair_names[o->x]); break;
+            case OP_SHIFT:      fprintf(f, "%s %s", shift_names[o->x], reg_names[o->y]); break;
+            case OP_BIT:        fprintf(f, "bit %d,%s", o->x, reg_names[o->y]); break;
+            case OP_SET:        fprintf(f, "set %d,%s", o->x, reg_names[o->y]); break;
+            case OP_RES:        fprintf(f, "res %d,%s", o->x, reg_names[o->y]); break;
+            case OP_RLCA:       fprintf(f, "rlca"); break;
+            case OP_RRCA:       fprintf(f, "rrca"); break;
+            case OP_RLA:        fprintf(f, "rla"); break;
+            case OP_RRA:        fprintf(f, "rra"); break;
+            case OP_CPL:        fprintf(f, "cpl"); break;
+            case OP_NEG:        fprintf(f, "neg"); break;
+            case OP_SCF:        fprintf(f, "scf"); break;
+            case OP_CCF:        fprintf(f, "ccf"); break;
+            case OP_JP:         print_jump(f, p, "jp", o, syntax); break;
+            case OP_JPHL:       fprintf(f, "jp (hl)"); break;
+            case OP_JR:         print_jump(f, p, "jr", o, syntax); break;
+            case OP_DJNZ:       fprintf(f, "djnz "); print_label(f, p, o->sym, syntax); break;
+            case OP_CALL:       print_jump(f, p, "call", o, syntax); break;
+            case OP_RET:        fprintf(f, o->x==CC_ALWAYS ? "ret" : "ret %s", cond_names[o->x]); break;
+            case OP_PUSH:       fprintf(f, "push %s", pair_names[o->x]); break;
+            case OP_POP:        fprintf(f, "pop %s", pair_names[o->x]); break;
+            case OP_EXDEHL:     fprintf(f, "ex de,hl"); break;
+            case OP_EXSPHL:     fprintf(f, "ex (sp),hl"); break;
+            case OP_EXAF:       fprintf(f, "ex af,af'"); break;
+            case OP_LDI:        fprintf(f, "ldi"); break;
+            case OP_LDIR:       fprintf(f, "ldir"); break;
+        }
+        fprintf(f, "\n");
+    }
+    fprintf(f, "\n");
+}
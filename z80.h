@@ -0,0 +1,161 @@
+#ifndef Z80_H
+#define Z80_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+
+A small Z80 model to measure the routines that read the tables. Routines are built in C as a list of
+instructions (no assembler involved), and the same list can be executed, with T-states counted the way the
+Z80 manual lists them, or printed as source: sjasm/z80asm for the reports, sdasz80 for the files the game links
+with the SDCC toolchain (# immediates, nnnn$ local labels, the routine exported in _CODE).
+
+Only the instructions the routines need are there, and only the S, Z, P/V and C flags are kept. IX/IY are left
+out on purpose: they cost 4 to 8 extra T-states per access and the runtime code shouldn't use them.
+
+On the MSX every M1 cycle (opcode fetch) gets one wait state, so the MSX cost is tstates + m1.
+
+*/
+
+#define Z80_CLOCK           3579545
+#define Z80_FRAME_60HZ      (Z80_CLOCK/60)
+#define Z80_FRAME_50HZ      (Z80_CLOCK/50)
+#define Z80_MAX_SYMBOLS     256
+
+// Assembler syntax of z80_print()
+enum Z80_SYNTAX {Z80_SJASM, Z80_SDAS};
+// 8 bit registers, in the order of the opcode encoding. R_HLI is (HL)
+enum Z80_REGS {R_B, R_C, R_D, R_E, R_H, R_L, R_HLI, R_A};
+// Register pairs. RP_AF only for PUSH/POP
+enum Z80_PAIRS {RP_BC, RP_DE, RP_HL, RP_SP, RP_AF};
+// Conditions, in the order of the opcode encoding
+enum Z80_CONDS {CC_NZ, CC_Z, CC_NC, CC_C, CC_PO, CC_PE, CC_P, CC_M, CC_ALWAYS};
+enum Z80_ALU {ALU_ADD, ALU_ADC, ALU_SUB, ALU_SBC, ALU_AND, ALU_XOR, ALU_OR, ALU_CP};
+enum Z80_SHIFTS {SH_RLC, SH_RRC, SH_RL, SH_RR, SH_SLA, SH_SRA, SH_SLL, SH_SRL};
+
+enum Z80_OPS{
+    OP_LABEL,       // not an instruction, jump target
+    OP_LD,          // LD r,r'
+    OP_LDN,         // LD r,n
+    OP_LD16,        // LD rr,nn
+    OP_LDA_MEM,     // LD A,(nn)
+    OP_LDMEM_A,     // LD (nn),A
+    OP_LDA_RP,      // LD A,(BC) / LD A,(DE)
+    OP_LDRP_A,      // LD (BC),A / LD (DE),A
+    OP_LDHL_MEM,    // LD HL,(nn)
+    OP_LDMEM_HL,    // LD (nn),HL
+    OP_LDSP_HL,     // LD SP,HL
+    OP_ALU,         // ADD/ADC/SUB/SBC/AND/XOR/OR/CP r
+    OP_ALUN,        // ADD/ADC/SUB/SBC/AND/XOR/OR/CP n
+    OP_INC,         // INC r
+    OP_DEC,         // DEC r
+    OP_INC16,       // INC rr
+    OP_DEC16,       // DEC rr
+    OP_ADD16,       // ADD HL,rr
+    OP_ADC16,       // ADC HL,rr
+    OP_SBC16,       // SBC HL,rr
+    OP_SHIFT,       // RLC/RRC/RL/RR/SLA/SRA/SLL/SRL r
+    OP_BIT,         // BIT b,r
+    OP_SET,         // SET b,r
+    OP_RES,         // RES b,r
+    OP_RLCA, OP_RRCA, OP_RLA, OP_RRA, OP_CPL, OP_NEG, OP_SCF, OP_CCF,
+    OP_JP,          // JP cc,nn
+    OP_JPHL,        // JP (HL)
+    OP_JR,          // JR cc,e
+    OP_DJNZ,
+    OP_CALL,        // CALL cc,nn
+    OP_RET,         // RET cc
+    OP_PUSH,
+    OP_POP,
+    OP_EXDEHL,
+    OP_EXSPHL,      // EX (SP),HL
+    OP_EXAF,
+    OP_LDI,
+    OP_LDIR,
+    OP_NOP
+};
+
+typedef struct Z80Op{
+    uint8_t     op, x, y;   // operands: registers, pairs, conditions, ALU operation or bit number
+    int32_t     n;          // immediate value, or offset added to sym
+    const char  *sym;       // symbol (memory) or label (jumps), NULL if none
+    int32_t     target;     // filled by z80_link(): address, or index of the label
+}Z80Op;
+
+typedef struct Z80Program{
+    const char  *name;
+    Z80Op       *ops;
+    int         count, size;
+}Z80Program;
+
+typedef struct Z80Symbol{
+    const char  *name;
+    uint16_t    addr;
+}Z80Symbol;
+
+typedef struct Z80{
+    uint8_t     r[8];       // B C D E H L - A, same order as enum Z80_REGS
+    uint8_t     f, a2, f2;  // flags and the AF' pair
+    uint16_t    sp;
+    long        tstates, m1, reads, writes;
+    uint16_t    watch_start, watch_end;     // reads in [watch_start, watch_end) also count in watched
+    long        watched;
+    Z80Symbol   symbols[Z80_MAX_SYMBOLS];
+    int         nsymbols;
+    uint8_t     mem[65536];
+}Z80;
+
+#define Z80_FLAG_C  0x01
+#define Z80_FLAG_PV 0x04
+#define Z80_FLAG_Z  0x40
+#define Z80_FLAG_S  0x80
+
+Z80Program *z80_new(const char *name);
+void z80_free(Z80Program *p);
+void z80_op(Z80Program *p, int op, int x, int y, int32_t n, const char *sym);
+void z80_symbol(Z80 *cpu, const char *name, uint16_t addr);
+void z80_load(Z80 *cpu, const char *name, uint16_t addr, const uint8_t *data, int size);
+bool z80_link(Z80 *cpu, Z80Program *p);
+long z80_call(Z80 *cpu, Z80Program *p);
+int z80_size(const Z80Program *p);
+void z80_print(FILE *f, const Z80Program *p, int syntax);
+
+uint16_t z80_pair(const Z80 *cpu, int rp);
+void z80_set_pair(Z80 *cpu, int rp, uint16_t v);
+
+// Instruction builders, one per line of assembly
+static inline void z_label(Z80Program *p, const char *l)            { z80_op(p, OP_LABEL, 0, 0, 0, l); }
+static inline void z_ld(Z80Program *p, int d, int s)                { z80_op(p, OP_LD, d, s, 0, NULL); }
+static inline void z_ldn(Z80Program *p, int d, int n)               { z80_op(p, OP_LDN, d, 0, n, NULL); }
+static inline void z_ld16(Z80Program *p, int rp, int n, const char *sym) { z80_op(p, OP_LD16, rp, 0, n, sym); }
+static inline void z_lda_mem(Z80Program *p, int n, const char *sym) { z80_op(p, OP_LDA_MEM, 0, 0, n, sym); }
+static inline void z_ldmem_a(Z80Program *p, int n, const char *sym) { z80_op(p, OP_LDMEM_A, 0, 0, n, sym); }
+static inline void z_lda_rp(Z80Program *p, int rp)                  { z80_op(p, OP_LDA_RP, rp, 0, 0, NULL); }
+static inline void z_ldrp_a(Z80Program *p, int rp)                  { z80_op(p, OP_LDRP_A, rp, 0, 0, NULL); }
+static inline void z_ldhl_mem(Z80Program *p, int n, const char *sym){ z80_op(p, OP_LDHL_MEM, 0, 0, n, sym); }
+static inline void z_ldmem_hl(Z80Program *p, int n, const char *sym){ z80_op(p, OP_LDMEM_HL, 0, 0, n, sym); }
+static inline void z_alu(Z80Program *p, int aop, int r)             { z80_op(p, OP_ALU, aop, r, 0, NULL); }
+static inline void z_alun(Z80Program *p, int aop, int n)            { z80_op(p, OP_ALUN, aop, 0, n, NULL); }
+static inline void z_inc(Z80Program *p, int r)                      { z80_op(p, OP_INC, r, 0, 0, NULL); }
+static inline void z_dec(Z80Program *p, int r)                      { z80_op(p, OP_DEC, r, 0, 0, NULL); }
+static inline void z_inc16(Z80Program *p, int rp)                   { z80_op(p, OP_INC16, rp, 0, 0, NULL); }
+static inline void z_dec16(Z80Program *p, int rp)                   { z80_op(p, OP_DEC16, rp, 0, 0, NULL); }
+static inline void z_add16(Z80Program *p, int rp)                   { z80_op(p, OP_ADD16, rp, 0, 0, NULL); }
+static inline void z_adc16(Z80Program *p, int rp)                   { z80_op(p, OP_ADC16, rp, 0, 0, NULL); }
+static inline void z_sbc16(Z80Program *p, int rp)                   { z80_op(p, OP_SBC16, rp, 0, 0, NULL); }
+static inline void z_shift(Z80Program *p, int sop, int r)           { z80_op(p, OP_SHIFT, sop, r, 0, NULL); }
+static inline void z_bit(Z80Program *p, int b, int r)               { z80_op(p, OP_BIT, b, r, 0, NULL); }
+static inline void z_set(Z80Program *p, int b, int r)               { z80_op(p, OP_SET, b, r, 0, NULL); }
+static inline void z_res(Z80Program *p, int b, int r)               { z80_op(p, OP_RES, b, r, 0, NULL); }
+static inline void z_simple(Z80Program *p, int op)                  { z80_op(p, op, 0, 0, 0, NULL); }
+static inline void z_jp(Z80Program *p, int cc, const char *l)       { z80_op(p, OP_JP, cc, 0, 0, l); }
+static inline void z_jr(Z80Program *p, int cc, const char *l)       { z80_op(p, OP_JR, cc, 0, 0, l); }
+static inline void z_djnz(Z80Program *p, const char *l)             { z80_op(p, OP_DJNZ, 0, 0, 0, l); }
+static inline void z_call(Z80Program *p, int cc, const char *l)     { z80_op(p, OP_CALL, cc, 0, 0, l); }
+static inline void z_ret(Z80Program *p, int cc)                     { z80_op(p, OP_RET, cc, 0, 0, NULL); }
+static inline void z_push(Z80Program *p, int rp)                    { z80_op(p, OP_PUSH, rp, 0, 0, NULL); }
+static inline void z_pop(Z80Program *p, int rp)                     { z80_op(p, OP_POP, rp, 0, 0, NULL); }
+
+#endif
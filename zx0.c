@@ -0,0 +1,304 @@
+#include <stdlib.h>
+#include <string.h>
+#include "generator.h"
+#include "z80.h"
+
+/*
+
+ZX0 packing of the tables that are only needed in some stages. They go in the ROM packed, and the game unpacks
+them to RAM at stage load with dzx0_standard, Einar Saukas' 68 bytes decompressor (ZX0 v2 format, the same
+streams the zx0 tool makes, so salvador or zx0 -d unpack them too).
+
+The parser is a small optimal parse over two states, "the last block was literals" and "the last block was a
+match", with the last offset followed along the best path only. The reference zx0 keeps every offset and packs
+a few bytes smaller, but tables of a few KB pack here in a blink.
+
+Every stream is unpacked by dzx0_standard on the Z80 model and compared with the table, so the T-states of the
+report are the real ones, and a bad stream never reaches the header.
+
+*/
+
+#define ZX0_MAX_OFFSET  32640
+#define ZX0_MAX_RAW     0x7000      // from ZX0_RAM to below the stack
+#define ZX0_ROM         0x4000
+#define ZX0_RAM         0x8000
+#define ZX0_STACK       0xF380
+
+enum ZX0_BLOCKS {ZX0_NONE, ZX0_LITERALS, ZX0_MATCH, ZX0_REPEAT};
+
+typedef struct Zx0State{
+    long    cost;           // bits
+    int     from, length, offset, last;
+    uint8_t kind, from_state;
+}Zx0State;
+
+static Z80 zx0_cpu;
+static int zx0_tables, zx0_raw, zx0_packed;
+
+static int zx0_gamma_bits(int value){
+    int bits=1;
+
+    while(value>1){
+        value>>=1;
+        bits+=2;
+    }
+    return bits;
+}
+
+// The blocks of the best parse, in order. Returns how many
+static int zx0_parse(const uint8_t *in, int size, Zx0State *blocks){
+    Zx0State (*best)[2]=malloc((size+1)*sizeof(*best));
+    int count=0;
+    long none=(long)size*64+1024;     // more bits than any parse
+
+    for(int i=0;i<=size;i++)
+        best[i][0].cost=best[i][1].cost=none;
+    for(int j=1;j<=size;j++){
+        // a literal run k..j, the first block needs no indicator bit
+        for(int k=j-1;k>=0;k--){
+            long cost=k ? best[k][1].cost+1 : 0;
+            if(k && cost>=none)
+                continue;
+            cost+=zx0_gamma_bits(j-k)+8*(j-k);
+            if(cost<best[j][0].cost)
+                best[j][0]=(Zx0State){cost, k, j-k, 0, k ? best[k][1].last : 1, ZX0_LITERALS, 1};
+        }
+        if(best[j][0].cost>=none && best[j][1].cost>=none)
+            continue;
+        // the matches that start at j, the smallest offset for every length
+        int max=0;
+        for(int offset=1;offset<=j && offset<=ZX0_MAX_OFFSET && max<size-j;offset++){
+            int length=0;
+            while(j+length<size && in[j+length]==in[j+length-offset])
+                length++;
+            for(int l=max+1;l<=length;l++){
+                if(l<2)
+                    continue;
+                for(int s=0;s<2;s++){
+                    long cost=best[j][s].cost;
+                    if(cost>=none)
+                        continue;
+                    if(s==0 && offset==best[j][0].last)
+                        cost+=1+zx0_gamma_bits(l);
+                    else
+                        cost+=1+zx0_gamma_bits((offset-1)/128+1)+7+zx0_gamma_bits(l-1);
+                    if(cost<best[j+l][1].cost)
+                        best[j+l][1]=(Zx0State){cost, j, l, offset, offset,
+                            s==0 && offset==best[j][0].last ? ZX0_REPEAT : ZX0_MATCH, s};
+                }
+            }
+            if(length>max)
+                max=length;
+        }
+        // a repeat of length 1, only after literals
+        if(best[j][0].cost<none && best[j][0].last<=j && j<size && in[j]==in[j-best[j][0].last]){
+            long cost=best[j][0].cost+1+zx0_gamma_bits(1);
+            if(cost<best[j+1][1].cost)
+                best[j+1][1]=(Zx0State){cost, j, 1, best[j][0].last, best[j][0].last, ZX0_REPEAT, 0};
+        }
+    }
+    // back from the end, then reversed
+    for(int i=size, s=best[size][1].cost<best[size][0].cost;i>0;){
+        Zx0State *b=&best[i][s];
+        blocks[count++]=*b;
+        s=b->from_state;
+        i=b->from;
+    }
+    for(int i=0;i<count/2;i++){
+        Zx0State t=blocks[i];
+        blocks[i]=blocks[count-1-i];
+        blocks[count-1-i]=t;
+    }
+    free(best);
+    return count;
+}
+
+typedef struct Zx0Writer{
+    uint8_t *out;
+    int     index, bit_index, bit_mask;
+    bool    backtrack;
+}Zx0Writer;
+
+static void zx0_bit(Zx0Writer *w, int value){
+    if(w->backtrack){
+        if(value)
+            w->out[w->index-1]|=1;
+        w->backtrack=false;
+        return;
+    }
+    if(!w->bit_mask){
+        w->bit_mask=128;
+        w->bit_index=w->index;
+        w->out[w->index++]=0;
+    }
+    if(value)
+        w->out[w->bit_index]|=w->bit_mask;
+    w->bit_mask>>=1;
+}
+
+// Interlaced Elias gamma: a 0 before every bit under the top one, a 1 at the end
+static void zx0_gamma(Zx0Writer *w, int value, bool invert){
+    int i=1;
+
+    while(i<=value/2)
+        i<<=1;
+    while(i>>=1){
+        zx0_bit(w, 0);
+        zx0_bit(w, invert ? !(value&i) : (value&i)!=0);
+    }
+    zx0_bit(w, 1);
+}
+
+// Packs size bytes to out, which must have room for size+size/8+16. Returns the packed size
+int zx0_compress(const uint8_t *in, int size, uint8_t *out){
+    Zx0State *blocks=malloc(size*sizeof(Zx0State));
+    Zx0Writer w={out, 0, 0, 0, false};
+    int count=zx0_parse(in, size, blocks), index=0;
+
+    for(int i=0;i<count;i++){
+        Zx0State *b=&blocks[i];
+        if(b->kind==ZX0_LITERALS){
+            if(i)
+                zx0_bit(&w, 0);
+            zx0_gamma(&w, b->length, false);
+            for(int k=0;k<b->length;k++)
+                w.out[w.index++]=in[index+k];
+        }
+        else if(b->kind==ZX0_REPEAT){
+            zx0_bit(&w, 0);
+            zx0_gamma(&w, b->length, false);
+        }
+        else{
+            zx0_bit(&w, 1);
+            zx0_gamma(&w, (b->offset-1)/128+1, true);
+            w.out[w.index++]=(127-(b->offset-1)%128)<<1;
+            w.backtrack=true;
+            zx0_gamma(&w, b->length-1, false);
+        }
+        index+=b->length;
+    }
+    // end marker, an offset MSB of 256
+    zx0_bit(&w, 1);
+    zx0_gamma(&w, 256, true);
+    free(blocks);
+    return w.index;
+}
+
+// dzx0_standard, HL the packed stream and DE the destination. SDCC's sdcccall(1) passes the two pointers there
+static Z80Program *zx0_routine(void){
+    Z80Program *p=z80_new("_dzx0_standard");
+
+    z_ld16(p, RP_BC, 0xFFFF, NULL);     // the first offset is 1
+    z_push(p, RP_BC);
+    z_inc16(p, RP_BC);
+    z_ldn(p, R_A, 0x80);
+    z_label(p, "dzx0s_literals");
+    z_call(p, CC_ALWAYS, "dzx0s_elias");
+    z_simple(p, OP_LDIR);
+    z_alu(p, ALU_ADD, R_A);
+    z_jr(p, CC_C, "dzx0s_new_offset");
+    z_call(p, CC_ALWAYS, "dzx0s_elias");
+    z_label(p, "dzx0s_copy");
+    z_simple(p, OP_EXSPHL);             // source on the stack, the offset in hl
+    z_push(p, RP_HL);
+    z_add16(p, RP_DE);
+    z_simple(p, OP_LDIR);
+    z_pop(p, RP_HL);
+    z_simple(p, OP_EXSPHL);
+    z_alu(p, ALU_ADD, R_A);
+    z_jr(p, CC_NC, "dzx0s_literals");
+    z_label(p, "dzx0s_new_offset");
+    z_pop(p, RP_BC);
+    z_ldn(p, R_C, 0xFE);
+    z_call(p, CC_ALWAYS, "dzx0s_elias_loop");
+    z_inc(p, R_C);
+    z_ret(p, CC_Z);                     // end marker
+    z_ld(p, R_B, R_C);
+    z_ld(p, R_C, R_HLI);
+    z_inc16(p, RP_HL);
+    z_shift(p, SH_RR, R_B);             // the last offset bit is the first length bit
+    z_shift(p, SH_RR, R_C);
+    z_push(p, RP_BC);
+    z_ld16(p, RP_BC, 1, NULL);
+    z_call(p, CC_NC, "dzx0s_elias_backtrack");
+    z_inc16(p, RP_BC);
+    z_jr(p, CC_ALWAYS, "dzx0s_copy");
+    z_label(p, "dzx0s_elias");
+    z_inc(p, R_C);
+    z_label(p, "dzx0s_elias_loop");
+    z_alu(p, ALU_ADD, R_A);
+    z_jr(p, CC_NZ, "dzx0s_elias_skip");
+    z_ld(p, R_A, R_HLI);                // 8 more bits
+    z_inc16(p, RP_HL);
+    z_simple(p, OP_RLA);
+    z_label(p, "dzx0s_elias_skip");
+    z_ret(p, CC_C);
+    z_label(p, "dzx0s_elias_backtrack");
+    z_alu(p, ALU_ADD, R_A);
+    z_shift(p, SH_RL, R_C);
+    z_shift(p, SH_RL, R_B);
+    z_jr(p, CC_ALWAYS, "dzx0s_elias_loop");
+    return p;
+}
+
+// Packs a table, unpacks it on the model and reports the sizes and the T-states on stderr. Returns the packed
+// size, or 0 if the table can't be unpacked to RAM
+int zx0_pack(const char *name, const uint8_t *in, int size, uint8_t *out){
+    Z80Program *p;
+    int packed;
+    long t, m1;
+
+    if(size>ZX0_MAX_RAW){
+        fprintf(stderr, "zx0: %s takes %d bytes, more than the %d bytes of RAM it could be unpacked to\n", name, size, ZX0_MAX_RAW);
+        return 0;
+    }
+    packed=zx0_compress(in, size, out);
+    p=zx0_routine();
+    if(packed>ZX0_RAM-ZX0_ROM || !z80_link(&zx0_cpu, p)){
+        z80_free(p);
+        return 0;
+    }
+    memset(zx0_cpu.mem+ZX0_RAM, 0, size);
+    memcpy(zx0_cpu.mem+ZX0_ROM, out, packed);
+    z80_set_pair(&zx0_cpu, RP_HL, ZX0_ROM);
+    z80_set_pair(&zx0_cpu, RP_DE, ZX0_RAM);
+    zx0_cpu.sp=ZX0_STACK;
+    m1=zx0_cpu.m1;
+    t=z80_call(&zx0_cpu, p);
+    m1=zx0_cpu.m1-m1;
+    z80_free(p);
+    if(memcmp(zx0_cpu.mem+ZX0_RAM, in, size) || z80_pair(&zx0_cpu, RP_DE)!=ZX0_RAM+size){
+        fprintf(stderr, "zx0: %s doesn't unpack back to the table\n", name);
+        return 0;
+    }
+    fprintf(stderr, "zx0: %-22s %5d bytes packed to %5d (%3d%%), unpacked in %7ld T-states (%7ld on MSX, %.2f frames), %5d bytes of RAM\n",
+        name, size, packed, packed*100/size, t, t+m1, (double)(t+m1)/Z80_FRAME_60HZ, size);
+    zx0_tables++;
+    zx0_raw+=size;
+    zx0_packed+=packed;
+    return packed;
+}
+
+// Writes dzx0_standard.asm for the game to link, and the totals on stderr
+bool zx0_finish(const char *dir){
+    char path[1024];
+    Z80Program *p;
+    FILE *f;
+
+    if(!zx0_tables)
+        return true;
+    snprintf(path, sizeof(path), "%s/dzx0_standard.asm", dir);
+    if(!(f=fopen(path, "w"))){
+        fprintf(stderr, "zx0: can't write %s\n", path);
+        return false;
+    }
+    p=zx0_routine();
+    fprintf(f, "; ZX0 v2 decompressor by Einar Saukas, \"standard\" version, %d bytes\n", z80_size(p));
+    fprintf(f, "; void dzx0_standard(const void *src, void *dst), hl = src, de = dst\n\n");
+    z80_print(f, p, Z80_SDAS);
+    fclose(f);
+    z80_free(p);
+    fprintf(stderr, "zx0: %d tables, %d bytes of ROM instead of %d, %d bytes of RAM to unpack them\n",
+        zx0_tables, zx0_packed, zx0_raw, zx0_raw);
+    return true;
+}